@@ -0,0 +1,229 @@
+#ifndef ASYNC_DOT_EXPORTER_H
+#define ASYNC_DOT_EXPORTER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include <gegelati.h>
+
+/**
+* \brief Export TPGGraphs in dot files from a background thread.
+*
+* Each export copies the vertices and edges of the graph in a snapshot
+* TPGGraph, sharing the programs of the original graph, which are never
+* modified once in a graph. The snapshot is then written by the background
+* thread, while the training continues with the original graph.
+*
+* Programs are modified by TPGGraph::clearProgramIntrons(): flush() must be
+* called before clearing introns of a graph with pending exports.
+*/
+class AsyncDotExporter
+{
+protected:
+	/// A snapshot waiting to be written.
+	struct PendingExport
+	{
+		std::string path;
+		std::unique_ptr<TPG::TPGGraph> snapshot;
+		bool isCheckpoint;
+	};
+
+	/// Graph to export.
+	const TPG::TPGGraph& graph;
+
+	/// Number of generations between two checkpoints.
+	uint64_t period;
+
+	/// Number of checkpoint files kept on disk, 0 to keep them all.
+	size_t nbKept;
+
+	/// Maximum number of snapshots waiting to be written. When the disk is
+	/// too slow, the oldest pending checkpoints are skipped.
+	size_t maxNbPending;
+
+	/// Snapshots waiting to be written.
+	std::deque<PendingExport> pending;
+
+	/// Checkpoint files written, from the oldest to the newest.
+	std::deque<std::string> written;
+
+	/// Whether the background thread is writing a snapshot.
+	bool writing = false;
+
+	/// Set to end the background thread.
+	bool stopping = false;
+
+	/// Protects pending, writing and stopping.
+	std::mutex mutex;
+
+	/// Notified when a snapshot is queued, written, or on stop.
+	std::condition_variable condition;
+
+	/// Background thread writing the snapshots.
+	std::thread thread;
+
+	/// Copy the vertices and edges of the graph, in their original order so
+	/// that the dot file is identical to the one of the original graph.
+	std::unique_ptr<TPG::TPGGraph> snapshotGraph() const
+	{
+		std::unique_ptr<TPG::TPGGraph> snapshot(new TPG::TPGGraph(graph.getEnvironment()));
+		std::unordered_map<const TPG::TPGVertex*, const TPG::TPGVertex*> copies;
+		for (const TPG::TPGVertex* vertex : graph.getVertices()) {
+			const TPG::TPGAction* action = dynamic_cast<const TPG::TPGAction*>(vertex);
+			copies[vertex] = (action != NULL) ? (const TPG::TPGVertex*)&snapshot->addNewAction(action->getActionID())
+				: (const TPG::TPGVertex*)&snapshot->addNewTeam();
+		}
+		for (const std::unique_ptr<TPG::TPGEdge>& edge : graph.getEdges()) {
+			snapshot->addNewEdge(*copies[edge->getSource()], *copies[edge->getDestination()], edge->getProgramSharedPointer());
+		}
+		return snapshot;
+	}
+
+	/// Queue a snapshot of the graph.
+	void enqueue(const std::string& path, bool isCheckpoint)
+	{
+		PendingExport pendingExport{path, snapshotGraph(), isCheckpoint};
+
+		std::lock_guard<std::mutex> lock(mutex);
+		// Skip the oldest checkpoint if the disk can not keep up.
+		if (isCheckpoint && maxNbPending > 0) {
+			for (auto it = pending.begin(); pending.size() >= maxNbPending && it != pending.end();) {
+				it = it->isCheckpoint ? pending.erase(it) : it + 1;
+			}
+		}
+		pending.push_back(std::move(pendingExport));
+		condition.notify_all();
+	}
+
+	/// Body of the background thread.
+	void run()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true) {
+			condition.wait(lock, [this]() { return stopping || !pending.empty(); });
+			if (pending.empty()) {
+				return;
+			}
+			PendingExport pendingExport = std::move(pending.front());
+			pending.pop_front();
+			writing = true;
+			lock.unlock();
+
+			File::TPGGraphDotExporter dotExporter(pendingExport.path.c_str(), *pendingExport.snapshot);
+			dotExporter.print();
+			pendingExport.snapshot.reset();
+
+			// Rotate the checkpoint files
+			if (pendingExport.isCheckpoint && nbKept > 0) {
+				written.push_back(pendingExport.path);
+				while (written.size() > nbKept) {
+					std::remove(written.front().c_str());
+					written.pop_front();
+				}
+			}
+
+			lock.lock();
+			writing = false;
+			condition.notify_all();
+		}
+	}
+
+public:
+	/**
+	* \brief Constructor.
+	*
+	* \param[in] graph the TPGGraph to export.
+	* \param[in] period number of generations between two checkpoints.
+	* \param[in] nbKept number of checkpoint files kept on disk, 0 to keep
+	* them all.
+	* \param[in] maxNbPending maximum number of checkpoints waiting to be
+	* written, 0 for no limit.
+	*/
+	AsyncDotExporter(const TPG::TPGGraph& graph, uint64_t period = 1, size_t nbKept = 0, size_t maxNbPending = 2)
+		: graph{graph}, period{(period > 0) ? period : 1}, nbKept{nbKept}, maxNbPending{maxNbPending}
+	{
+		thread = std::thread(&AsyncDotExporter::run, this);
+	}
+
+	/// Write the pending snapshots and stop the background thread.
+	~AsyncDotExporter()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		condition.notify_all();
+		thread.join();
+	}
+
+	/**
+	* \brief Export a checkpoint of the graph, if the generation is a
+	* multiple of the period.
+	*
+	* Only the nbKept most recent checkpoint files are kept on disk.
+	*
+	* \param[in] generationNumber the current generation.
+	* \param[in] path the dot file of the checkpoint.
+	*/
+	void checkpoint(uint64_t generationNumber, const std::string& path)
+	{
+		if (generationNumber % period == 0) {
+			enqueue(path, true);
+		}
+	}
+
+	/// Export the graph in a dot file, never skipped nor rotated.
+	void exportGraph(const std::string& path)
+	{
+		enqueue(path, false);
+	}
+
+	/**
+	* \brief Read the checkpoint parameters from the command line.
+	*
+	* Recognized options are "-dotPeriod <period>" and "-dotKept <nbKept>".
+	* Other arguments are ignored, and parameters absent from the command
+	* line keep their value. getopt is not used, to build with Visual Studio
+	* too.
+	*
+	* \param[in] argc number of arguments of main().
+	* \param[in] argv arguments of main().
+	* \param[in,out] period number of generations between two checkpoints.
+	* \param[in,out] nbKept number of checkpoint files kept on disk, 0 to
+	* keep them all.
+	*/
+	static void parseCommandLine(int argc, char** argv, uint64_t& period, size_t& nbKept)
+	{
+		for (int i = 1; i + 1 < argc; i++) {
+			if (strcmp("-dotPeriod", argv[i]) == 0) {
+				period = strtoull(argv[++i], NULL, 10);
+				if (period == 0) {
+					std::cerr << "Invalid dot export period, 1 is used." << std::endl;
+					period = 1;
+				}
+			}
+			else if (strcmp("-dotKept", argv[i]) == 0) {
+				nbKept = (size_t)strtoull(argv[++i], NULL, 10);
+			}
+		}
+	}
+
+	/// Wait until all the pending snapshots are written.
+	void flush()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		condition.wait(lock, [this]() { return pending.empty() && !writing; });
+	}
+};
+
+#endif // !ASYNC_DOT_EXPORTER_H
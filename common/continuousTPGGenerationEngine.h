@@ -0,0 +1,248 @@
+#ifndef CONTINUOUS_TPG_GENERATION_ENGINE_H
+#define CONTINUOUS_TPG_GENERATION_ENGINE_H
+
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <list>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gegelati.h>
+
+/**
+* \brief Code generation of the continuous execution of a TPG.
+*
+* The switch code generation of GEGELATI compiles the discrete execution of a
+* TPG: the generated inferenceTPG() function returns the ID of the TPGAction
+* reached from the root. The continuous execution of the TPGExecutionEngine,
+* with one activable edge per team, follows the same winning edges, but
+* outputs the bid of the program of the last edge, through the activation
+* function, instead of the ID of its action.
+*
+* After the generation of GEGELATI, this engine writes an
+* inferenceContinuousTPG(double* actions) C function doing this execution
+* with the P*() functions of the generated <name>_program.c file: at each
+* team, the programs of the edges not leading to an already visited team
+* are executed, and the edge with the highest bid wins. NaN bids are the
+* lowest, and the first edge wins ties. When the winning edge leads to an
+* action, its activated bid is written in the continuous action of this
+* action, the others keep their initial value.
+*
+* Action IDs are mapped on the continuous actions modulo their number: each
+* actuator of a MuJoCo task has its own action, and all the actions of the
+* Pendulum drive its single torque.
+*
+* TPGs using memory registers can not be compiled, the registers of the
+* generated programs are not kept between executions.
+*/
+class ContinuousTPGGenerationEngine : public CodeGen::TPGSwitchGenerationEngine
+{
+protected:
+	/// Name of the generated files.
+	std::string filename;
+
+	/// Folder of the generated files, ending with a '/'.
+	std::string path;
+
+	/// Generated graph.
+	const TPG::TPGGraph& graph;
+
+	/// Write a double in C, with all its digits.
+	static void writeValue(std::ostream& out, double value)
+	{
+		if (std::isnan(value)) {
+			out << "NAN";
+		}
+		else if (std::isinf(value)) {
+			out << ((value < 0) ? "-INFINITY" : "INFINITY");
+		}
+		else {
+			out << std::setprecision(17) << value;
+		}
+	}
+
+	/**
+	* \brief Get the C expression of an activation function applied to the
+	* bid variable.
+	*
+	* \throw std::runtime_error if the activation function is not supported.
+	*/
+	static std::string getActivationCode(const std::string& activationFunction)
+	{
+		if (activationFunction.empty() || activationFunction == "none") {
+			return "bid";
+		}
+		if (activationFunction == "tanh") {
+			return "tanh(bid)";
+		}
+		if (activationFunction == "sigmoid") {
+			return "1.0 / (1.0 + exp(-bid))";
+		}
+		if (activationFunction == "relu") {
+			return "(bid > 0.0) ? bid : 0.0";
+		}
+		throw std::runtime_error("Unsupported activation function " + activationFunction);
+	}
+
+	/// Index of each team reachable from the root, the root being 0.
+	std::map<const TPG::TPGVertex*, uint64_t> indexTeams(const TPG::TPGVertex* root) const
+	{
+		std::map<const TPG::TPGVertex*, uint64_t> teams;
+		std::deque<const TPG::TPGVertex*> toVisit = { root };
+		teams.emplace(root, 0);
+		while (!toVisit.empty()) {
+			const TPG::TPGVertex* team = toVisit.front();
+			toVisit.pop_front();
+			for (const TPG::TPGEdge* edge : team->getOutgoingEdges()) {
+				const TPG::TPGVertex* destination = edge->getDestination();
+				if (dynamic_cast<const TPG::TPGTeam*>(destination) != NULL && teams.emplace(destination, teams.size()).second) {
+					toVisit.push_back(destination);
+				}
+			}
+		}
+		return teams;
+	}
+
+public:
+	/**
+	* \brief Constructor.
+	*
+	* \param[in] filename name of the generated files.
+	* \param[in] tpg graph with a single root.
+	* \param[in] path folder of the generated files, ending with a '/'.
+	*/
+	ContinuousTPGGenerationEngine(const std::string& filename, const TPG::TPGGraph& tpg, const std::string& path = "./")
+		: CodeGen::TPGSwitchGenerationEngine(filename, tpg, path), filename{filename}, path{path}, graph{tpg}
+	{
+	}
+
+	/**
+	* \brief Generate the code of GEGELATI, then the continuous execution.
+	*
+	* Writes <name>_continuous.h and <name>_continuous.c next to the files of
+	* GEGELATI. The <NAME>_NB_CONTINUOUS_ACTIONS macro of the header gives
+	* the number of values written by inferenceContinuousTPG().
+	*
+	* \param[in] initActions continuous actions before the execution, as
+	* given to the TPGExecutionEngine.
+	* \param[in] activationFunction activation function of the
+	* LearningEnvironment.
+	* \throw std::runtime_error if the graph does not have a single root, if
+	* the activation function is not supported, or if the files can not be
+	* written.
+	*/
+	void generateContinuousTPG(const std::vector<double>& initActions, const std::string& activationFunction)
+	{
+		if (graph.getNbRootVertices() != 1 || initActions.empty()) {
+			throw std::runtime_error("The continuous code generation needs a single root and at least one continuous action.");
+		}
+		std::string activationCode = getActivationCode(activationFunction);
+
+		// Program IDs are given by the generation of GEGELATI.
+		this->generateTPGGraph();
+
+		std::string macroName;
+		for (char c : filename) {
+			macroName += (char)std::toupper((unsigned char)c);
+		}
+		std::string nbActionsMacro = macroName + "_NB_CONTINUOUS_ACTIONS";
+
+		std::ofstream header(path + filename + "_continuous.h");
+		if (!header) {
+			throw std::runtime_error("Could not write " + path + filename + "_continuous.h");
+		}
+		header << "#ifndef " << macroName << "_CONTINUOUS_H\n";
+		header << "#define " << macroName << "_CONTINUOUS_H\n\n";
+		header << "/// Number of continuous actions filled by inferenceContinuousTPG().\n";
+		header << "#define " << nbActionsMacro << " " << initActions.size() << "\n\n";
+		header << "/// Fill the continuous actions of the TPG for the current inputs.\n";
+		header << "void inferenceContinuousTPG(double* actions);\n\n";
+		header << "#endif\n";
+
+		std::ofstream source(path + filename + "_continuous.c");
+		if (!source) {
+			throw std::runtime_error("Could not write " + path + filename + "_continuous.c");
+		}
+		std::map<const TPG::TPGVertex*, uint64_t> teams = indexTeams(graph.getRootVertices().front());
+		std::vector<const TPG::TPGVertex*> orderedTeams(teams.size());
+		for (const auto& team : teams) {
+			orderedTeams[team.second] = team.first;
+		}
+
+		source << "#include <math.h>\n";
+		source << "#include <stdint.h>\n\n";
+		source << "#include \"" << filename << "_program.h\"\n";
+		source << "#include \"" << filename << "_continuous.h\"\n\n";
+		source << "/// Continuous actions before the execution of the TPG.\n";
+		source << "static const double initActions[" << nbActionsMacro << "] = { ";
+		for (size_t i = 0; i < initActions.size(); i++) {
+			writeValue(source, initActions[i]);
+			source << ((i + 1 < initActions.size()) ? ", " : " ");
+		}
+		source << "};\n\n";
+		source << "/// Activation function applied to the bid of the last edge.\n";
+		source << "static double activation(double bid)\n{\n";
+		source << "\treturn " << activationCode << ";\n";
+		source << "}\n\n";
+		source << "/// Bid of a program, NaN being the lowest.\n";
+		source << "static double filterBid(double bid)\n{\n";
+		source << "\treturn isnan(bid) ? -INFINITY : bid;\n";
+		source << "}\n\n";
+
+		source << "void inferenceContinuousTPG(double* actions)\n{\n";
+		source << "\tint visited[" << orderedTeams.size() << "] = { 0 };\n";
+		source << "\tint currentTeam = 0;\n";
+		source << "\tfor (int i = 0; i < " << nbActionsMacro << "; i++) {\n";
+		source << "\t\tactions[i] = initActions[i];\n";
+		source << "\t}\n";
+		source << "\twhile (1) {\n";
+		source << "\t\tint bestEdge = -1;\n";
+		source << "\t\tdouble bestBid = -INFINITY;\n";
+		source << "\t\tvisited[currentTeam] = 1;\n";
+		source << "\t\tswitch (currentTeam) {\n";
+		for (uint64_t teamIdx = 0; teamIdx < orderedTeams.size(); teamIdx++) {
+			const std::list<TPG::TPGEdge*>& edges = orderedTeams[teamIdx]->getOutgoingEdges();
+			source << "\t\tcase " << teamIdx << ":\n";
+			uint64_t edgeIdx = 0;
+			for (const TPG::TPGEdge* edge : edges) {
+				auto destination = teams.find(edge->getDestination());
+				std::string bid = "filterBid(P" + std::to_string(this->findProgramID(edge->getProgram())) + "())";
+				source << "\t\t\t";
+				if (destination != teams.end()) {
+					source << "if (!visited[" << destination->second << "]) ";
+				}
+				source << "{ double bid = " << bid << "; if (bestEdge < 0 || bid > bestBid) { bestEdge = " << edgeIdx << "; bestBid = bid; } }\n";
+				edgeIdx++;
+			}
+			source << "\t\t\tswitch (bestEdge) {\n";
+			edgeIdx = 0;
+			for (const TPG::TPGEdge* edge : edges) {
+				auto destination = teams.find(edge->getDestination());
+				source << "\t\t\tcase " << edgeIdx << ": ";
+				if (destination != teams.end()) {
+					source << "currentTeam = " << destination->second << "; break;\n";
+				}
+				else {
+					uint64_t actionID = ((const TPG::TPGAction*)edge->getDestination())->getActionID();
+					source << "actions[" << actionID % initActions.size() << "] = activation(bestBid); return;\n";
+				}
+				edgeIdx++;
+			}
+			source << "\t\t\tdefault: return;\n";
+			source << "\t\t\t}\n";
+			source << "\t\t\tbreak;\n";
+		}
+		source << "\t\tdefault: return;\n";
+		source << "\t\t}\n";
+		source << "\t}\n";
+		source << "}\n";
+	}
+};
+
+#endif // !CONTINUOUS_TPG_GENERATION_ENGINE_H
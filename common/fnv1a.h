@@ -0,0 +1,51 @@
+#ifndef FNV1A_H
+#define FNV1A_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/// Offset basis of the 64-bit FNV-1a hash, the hash of an empty buffer.
+static const uint64_t FNV1A_OFFSET_BASIS = 14695981039346656037ULL;
+
+/**
+* \brief 64-bit FNV-1a hash of a buffer, chained from the given hash.
+*
+* Not a cryptographic hash: it is used to detect that the files a cache was
+* written from have changed.
+*/
+inline uint64_t fnv1a(const char* data, size_t size, uint64_t hash = FNV1A_OFFSET_BASIS)
+{
+	for (size_t i = 0; i < size; i++) {
+		hash ^= (uint8_t)data[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+/**
+* \brief 64-bit FNV-1a hash of the content of a file, chained from the given
+* hash.
+*
+* \param[in] path path of the file.
+* \param[out] hash the chained hash, left unchanged if the file can not be
+* opened.
+* \return false if the file can not be opened.
+*/
+inline bool fnv1aFile(const std::string& path, uint64_t& hash)
+{
+	std::ifstream file(path, std::ios::in | std::ios::binary);
+	if (!file) {
+		return false;
+	}
+	std::vector<char> buffer(1 << 16);
+	while (file) {
+		file.read(buffer.data(), buffer.size());
+		hash = fnv1a(buffer.data(), (size_t)file.gcount(), hash);
+	}
+	return true;
+}
+
+#endif // !FNV1A_H
@@ -0,0 +1,65 @@
+#ifndef TYPED_STATE_ARRAY_H
+#define TYPED_STATE_ARRAY_H
+
+#include <cstddef>
+
+#include <gegelati.h>
+
+/**
+* \brief PrimitiveTypeArray with typed accessors for the environments.
+*
+* Reading an element through getDataAt() allocates a shared pointer and
+* checks the requested type at each call. The accessors of this class read
+* and write the storage of the array directly, for the state reads and
+* writes of the environments at each action. The array is still provided to
+* the programs as a DataHandler through getDataSources().
+*
+* The storage of a PrimitiveTypeArray is never resized, so the pointer
+* returned by getRawData() stays valid for the lifetime of the array. Each
+* copy of the array has its own storage.
+*
+* \tparam T type of the elements.
+*/
+template <class T>
+class TypedStateArray : public Data::PrimitiveTypeArray<T>
+{
+public:
+	/// Constructor for an array of the given size.
+	TypedStateArray(size_t size = 8) : Data::PrimitiveTypeArray<T>(size) {};
+
+	/// Get the element at the given index, without bounds checking.
+	const T& get(size_t index) const
+	{
+		return this->data[index];
+	}
+
+	/// Set the element at the given index, without bounds checking.
+	void set(size_t index, const T& value)
+	{
+		this->data[index] = value;
+		this->invalidCachedHash = true;
+	}
+
+	/// Get a pointer to the contiguous storage of the array.
+	T* getRawData()
+	{
+		return this->data.data();
+	}
+
+	/// Get a pointer to the contiguous storage of the array.
+	const T* getRawData() const
+	{
+		return this->data.data();
+	}
+
+	/**
+	* \brief Invalidate the cached hash of the array after writes through
+	* getRawData().
+	*/
+	void invalidateHash()
+	{
+		this->invalidCachedHash = true;
+	}
+};
+
+#endif // !TYPED_STATE_ARRAY_H
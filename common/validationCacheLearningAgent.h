@@ -0,0 +1,222 @@
+#ifndef VALIDATION_CACHE_LEARNING_AGENT_H
+#define VALIDATION_CACHE_LEARNING_AGENT_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <gegelati.h>
+
+/**
+* \brief LearningAgent reusing the validation score of unchanged roots.
+*
+* In VALIDATION mode, the LearningEnvironments of these applications are
+* reset with a fixed seed, so a root whose subgraph and programs did not
+* change since its last validation gets exactly the same score. The score of
+* each validated root is cached with the identity of its subgraph, keyed by
+* a hash of this identity, and returned instead of simulating the root again.
+* On a hash match, the identities are compared, so that a hash collision
+* never gives a root the score of another one.
+*
+* The cache only holds the roots validated in the current or previous
+* generation.
+*
+* \tparam BaseAgent the LearningAgent extended with the cache.
+*/
+template <class BaseAgent = Learn::ParallelLearningAgent>
+class ValidationCacheLearningAgent : public BaseAgent
+{
+protected:
+	/**
+	* \brief Identity of the subgraph reachable from a root.
+	*
+	* Programs in a TPGGraph are never modified once evaluated, except for the
+	* removal of their introns, which does not change their results. Two
+	* subgraphs with the same structure and the same Program instances on
+	* their edges thus execute identically. The Programs are held, so that their
+	* addresses are not reused by other Programs while in the cache.
+	*/
+	struct SubgraphIdentity
+	{
+		/// Type and action ID of the vertices, number and destination of their edges.
+		std::vector<uint64_t> structure;
+
+		/// Program of each edge, in the order of the structure.
+		std::vector<std::shared_ptr<Program::Program>> programs;
+
+		bool operator==(const SubgraphIdentity& other) const
+		{
+			return structure == other.structure && programs == other.programs;
+		}
+	};
+
+	/// Validation result of a root, and the last generation it was used.
+	struct CacheEntry
+	{
+		SubgraphIdentity identity;
+		std::shared_ptr<Learn::EvaluationResult> result;
+		uint64_t generationNumber;
+	};
+
+	/// Validation results, indexed by the hash of the root subgraph identities.
+	mutable std::unordered_map<size_t, CacheEntry> validationCache;
+
+	/// Roots are evaluated in parallel by the ParallelLearningAgent.
+	mutable std::mutex cacheMutex;
+
+	/// Number of validations skipped since the beginning of the training.
+	mutable uint64_t nbCacheHits = 0;
+
+	/// Combine a value in a hash.
+	static void hashCombine(size_t& hash, size_t value)
+	{
+		hash ^= Data::Hash<size_t>()(value) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+	}
+
+public:
+	using BaseAgent::BaseAgent;
+
+	/**
+	* \brief Get the identity of the subgraph reachable from a root.
+	*
+	* Vertices are numbered in depth-first order, following their outgoing
+	* edges in order. The identity holds, for each vertex, its type, its
+	* action ID for actions, and for each outgoing edge its program and the
+	* number of its destination vertex.
+	*/
+	static SubgraphIdentity getSubgraphIdentity(const TPG::TPGVertex& root)
+	{
+		SubgraphIdentity identity;
+		std::unordered_map<const TPG::TPGVertex*, uint64_t> visited;
+		std::vector<const TPG::TPGVertex*> toVisit{&root};
+		while (!toVisit.empty()) {
+			const TPG::TPGVertex* vertex = toVisit.back();
+			toVisit.pop_back();
+			if (!visited.emplace(vertex, visited.size()).second) {
+				continue;
+			}
+
+			const TPG::TPGAction* action = dynamic_cast<const TPG::TPGAction*>(vertex);
+			identity.structure.push_back(action != NULL);
+			if (action != NULL) {
+				identity.structure.push_back(action->getActionID());
+			}
+
+			const std::list<TPG::TPGEdge*>& edges = vertex->getOutgoingEdges();
+			identity.structure.push_back(edges.size());
+			for (const TPG::TPGEdge* edge : edges) {
+				identity.programs.push_back(edge->getProgramSharedPointer());
+				auto destination = visited.find(edge->getDestination());
+				if (destination != visited.end()) {
+					// Already numbered vertex
+					identity.structure.push_back(destination->second);
+				}
+				else {
+					// Vertex numbered when visited
+					identity.structure.push_back(UINT64_MAX);
+					toVisit.push_back(edge->getDestination());
+				}
+			}
+		}
+		return identity;
+	}
+
+	/// Hash the identity of a subgraph.
+	static size_t hashSubgraphIdentity(const SubgraphIdentity& identity)
+	{
+		size_t hash = identity.structure.size();
+		for (uint64_t value : identity.structure) {
+			hashCombine(hash, value);
+		}
+		for (const std::shared_ptr<Program::Program>& program : identity.programs) {
+			hashCombine(hash, (size_t)program.get());
+		}
+		return hash;
+	}
+
+	/// Get the number of validations skipped thanks to the cache.
+	uint64_t getNbValidationCacheHits() const
+	{
+		std::lock_guard<std::mutex> lock(cacheMutex);
+		return nbCacheHits;
+	}
+
+	/**
+	* \brief Evaluate a root, reusing its cached score in VALIDATION mode.
+	*
+	* Other modes are evaluated by the BaseAgent.
+	*/
+	virtual std::shared_ptr<Learn::EvaluationResult> evaluateJob(
+		TPG::TPGExecutionEngine& tee, const Learn::Job& job,
+		uint64_t generationNumber, Learn::LearningMode mode,
+		Learn::LearningEnvironment& le) const override
+	{
+		if (mode != Learn::LearningMode::VALIDATION) {
+			return BaseAgent::evaluateJob(tee, job, generationNumber, mode, le);
+		}
+
+		SubgraphIdentity identity = getSubgraphIdentity(*job.getRoot());
+		size_t hash = hashSubgraphIdentity(identity);
+		{
+			std::lock_guard<std::mutex> lock(cacheMutex);
+			auto entry = validationCache.find(hash);
+			if (entry != validationCache.end() && entry->second.identity == identity) {
+				entry->second.generationNumber = generationNumber;
+				nbCacheHits++;
+				return copyResult(entry->second.result);
+			}
+		}
+
+		// Simulate outside of the lock, other roots are validated meanwhile.
+		std::shared_ptr<Learn::EvaluationResult> result = BaseAgent::evaluateJob(tee, job, generationNumber, mode, le);
+
+		std::lock_guard<std::mutex> lock(cacheMutex);
+		// On a collision, the entry of the other root is replaced.
+		validationCache[hash] = CacheEntry{std::move(identity), result, generationNumber};
+		return copyResult(result);
+	}
+
+	/**
+	* \brief Evaluate all the roots, and forget the cached validation scores
+	* of the roots that are no longer in the graph.
+	*/
+	virtual std::multimap<std::shared_ptr<Learn::EvaluationResult>, const TPG::TPGVertex*>
+		evaluateAllRoots(uint64_t generationNumber, Learn::LearningMode mode) override
+	{
+		auto results = BaseAgent::evaluateAllRoots(generationNumber, mode);
+		if (mode == Learn::LearningMode::VALIDATION) {
+			std::lock_guard<std::mutex> lock(cacheMutex);
+			for (auto it = validationCache.begin(); it != validationCache.end();) {
+				if (it->second.generationNumber + 1 < generationNumber) {
+					it = validationCache.erase(it);
+				}
+				else {
+					it++;
+				}
+			}
+		}
+		return results;
+	}
+
+protected:
+	/**
+	* \brief Give each root its own copy of a plain EvaluationResult, so that
+	* the cached one is never modified by the LearningAgent.
+	*
+	* Results of derived types are shared.
+	*/
+	static std::shared_ptr<Learn::EvaluationResult> copyResult(const std::shared_ptr<Learn::EvaluationResult>& result)
+	{
+		if (result && typeid(*result) == typeid(Learn::EvaluationResult)) {
+			return std::make_shared<Learn::EvaluationResult>(*result);
+		}
+		return result;
+	}
+};
+
+#endif // !VALIDATION_CACHE_LEARNING_AGENT_H
@@ -10,8 +10,8 @@ void GridWorld::reset(size_t seed, Learn::LearningMode mode, uint16_t iterationN
     score = 0.0;
 
     // Set data
-    currentState.setDataAt(typeid(double), 0, agentCoord[0]);
-    currentState.setDataAt(typeid(double), 1, agentCoord[1]);
+    currentState.set(0, agentCoord[0]);
+    currentState.set(1, agentCoord[1]);
 }
 
 bool GridWorld::positionAvailable(int pos_x, int pos_y){
@@ -70,8 +70,8 @@ void GridWorld::doAction(uint64_t action){
     score += reward;
 
     // Set data
-    currentState.setDataAt(typeid(double), 0, agentCoord[0]);
-    currentState.setDataAt(typeid(double), 1, agentCoord[1]);
+    currentState.set(0, agentCoord[0]);
+    currentState.set(1, agentCoord[1]);
 }
 
 bool GridWorld::isTerminal() const{
@@ -4,6 +4,8 @@
 
 #include <gegelati.h>
 
+#include "typedStateArray.h"
+
 class GridWorld : public Learn::LearningEnvironment{
 
     private:
@@ -32,7 +34,7 @@ class GridWorld : public Learn::LearningEnvironment{
 	    double score = 0.0;
 
         /// Current State
-        Data::PrimitiveTypeArray<double> currentState;
+        TypedStateArray<double> currentState;
 
     public:
 
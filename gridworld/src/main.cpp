@@ -9,8 +9,9 @@
 
 #include "gridworld.h"
 #include "instructions.h"
+#include "asyncDotExporter.h"
 
-int main() {
+int main(int argc, char** argv) {
 
 	std::cout << "Start GridWorld application." << std::endl;
 
@@ -41,7 +42,11 @@ int main() {
 	Log::LABasicLogger basicLogger(la);
 
 	// Create an exporter for all graphs
-	File::TPGGraphDotExporter dotExporter("out_0000.dot", *la.getTPGGraph());
+	// (checkpoint period and rotation can be set with -dotPeriod and -dotKept)
+	uint64_t dotPeriod = 1;
+	size_t dotNbKept = 0;
+	AsyncDotExporter::parseCommandLine(argc, argv, dotPeriod, dotNbKept);
+	AsyncDotExporter dotExporter(*la.getTPGGraph(), dotPeriod, dotNbKept);
 
 	// Logging best policy stat.
 	std::ofstream stats;
@@ -57,13 +62,15 @@ int main() {
 	for (int i = 0; i < params.nbGenerations; i++) {
 		char buff[13];
 		sprintf(buff, "out_%04d.dot", i);
-		dotExporter.setNewFilePath(buff);
-		dotExporter.print();
+		dotExporter.checkpoint(i, buff);
 
 		la.trainOneGeneration(i);
 
 	}
 
+	// Wait for the checkpoints, they share their programs with the graph.
+	dotExporter.flush();
+
 	// Keep best policy
 	la.keepBestPolicy();
 
@@ -71,8 +78,8 @@ int main() {
 	la.getTPGGraph()->clearProgramIntrons();
 
 	// Export the graph
-	dotExporter.setNewFilePath("out_best.dot");
-	dotExporter.print();
+	dotExporter.exportGraph("out_best.dot");
+	dotExporter.flush();
 
 	TPG::PolicyStats ps;
 	ps.setEnvironment(la.getTPGGraph()->getEnvironment());
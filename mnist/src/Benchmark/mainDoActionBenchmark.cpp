@@ -0,0 +1,67 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+
+#include "../mnist.h"
+
+/**
+* \brief Run nbSamples actions on the environment and return the number of
+* samples per second.
+*
+* \param[in] le the environment to evaluate.
+* \param[in] mode the LearningMode used to reset the environment.
+* \param[in] nbSamples number of actions to execute.
+* \param[in] nbActionsPerEval number of actions between two resets, as in
+* the learning process.
+*/
+double runSamples(MNIST& le, Learn::LearningMode mode, uint64_t nbSamples, uint64_t nbActionsPerEval)
+{
+	uint64_t checksum = 0;
+	le.reset(0, mode);
+
+	auto start = std::chrono::steady_clock::now();
+	for (uint64_t i = 0; i < nbSamples; i++) {
+		if (i % nbActionsPerEval == nbActionsPerEval - 1) {
+			le.reset(i, mode);
+		}
+		// Cycle over the actions, the answer does not change the cost.
+		le.doAction(i % 10);
+		checksum += le.getCurrentImageLabel();
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	// Prevent the loop from being optimized away.
+	if (checksum == 0) {
+		std::cout << "All labels are 0." << std::endl;
+	}
+	return nbSamples / std::chrono::duration<double>(end - start).count();
+}
+
+int main(int argc, char** argv) {
+
+	// Usage: mnistBenchmark [nbSamples [maxNbActionsPerEval]]
+	// (no getopt, to build with Visual Studio too)
+	uint64_t nbSamples = (argc > 1) ? atoll(argv[1]) : 1000000;
+	uint64_t nbActionsPerEval = (argc > 2) ? atoll(argv[2]) : 500;
+	if (nbSamples == 0 || nbActionsPerEval == 0) {
+		std::cout << "Usage: " << argv[0] << " [nbSamples [maxNbActionsPerEval]]" << std::endl;
+		exit(1);
+	}
+
+	MNIST mnistLE;
+
+	// Warm up caches.
+	runSamples(mnistLE, Learn::LearningMode::TRAINING, nbSamples / 10, nbActionsPerEval);
+
+	double trainingSamples = runSamples(mnistLE, Learn::LearningMode::TRAINING, nbSamples, nbActionsPerEval);
+	double validationSamples = runSamples(mnistLE, Learn::LearningMode::VALIDATION, nbSamples, nbActionsPerEval);
+	double testingSamples = runSamples(mnistLE, Learn::LearningMode::TESTING, nbSamples, nbActionsPerEval);
+
+	std::cout << "Samples: " << nbSamples << ", reset every " << nbActionsPerEval << " actions, "
+		<< sizeof(MNISTPixel) << " byte(s) per pixel" << std::endl;
+	std::cout << "doAction() TRAINING:   " << trainingSamples << " samples/s" << std::endl;
+	std::cout << "doAction() VALIDATION: " << validationSamples << " samples/s" << std::endl;
+	std::cout << "doAction() TESTING:    " << testingSamples << " samples/s" << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,133 @@
+#include <cctype>
+#include <cstdio>
+#include <iostream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <conio.h>
+#else
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#include "controlChannel.h"
+
+ControlChannel::ControlChannel() : exitRequested(false), printStatsRequested(false), printStatsAsyncRequested(false),
+	stopping(false), ready(false)
+{
+#ifndef _WIN32
+	if (pipe(this->wakeUpPipe) != 0) {
+		this->wakeUpPipe[0] = this->wakeUpPipe[1] = -1;
+	}
+#endif
+	this->thread = std::thread(&ControlChannel::run, this);
+
+	// Wait for the thread to print the available commands.
+	std::unique_lock<std::mutex> lock(this->mutex);
+	this->readyCondition.wait(lock, [this]() { return this->ready; });
+}
+
+ControlChannel::~ControlChannel()
+{
+	this->stop();
+#ifndef _WIN32
+	if (this->wakeUpPipe[0] >= 0) {
+		close(this->wakeUpPipe[0]);
+		close(this->wakeUpPipe[1]);
+	}
+#endif
+}
+
+void ControlChannel::stop()
+{
+	if (!this->thread.joinable()) {
+		return;
+	}
+	this->stopping = true;
+#ifndef _WIN32
+	if (this->wakeUpPipe[1] >= 0) {
+		char wakeUp = 0;
+		if (write(this->wakeUpPipe[1], &wakeUp, 1) != 1) {
+			// The thread still ends at its next poll timeout.
+		}
+	}
+#endif
+	this->thread.join();
+}
+
+void ControlChannel::run()
+{
+	std::cout << std::endl;
+	std::cout << "Press `q` then [Enter] to exit." << std::endl;
+	std::cout << "Press `p` then [Enter] to print classification statistics of the best root." << std::endl;
+	std::cout << "Press `a` then [Enter] to print them without pausing the training." << std::endl;
+	std::cout.flush();
+
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->ready = true;
+	}
+	this->readyCondition.notify_all();
+
+	char key;
+	while (!this->exitRequested && !this->stopping && this->waitKey(key)) {
+		this->handleKey(key);
+	}
+
+	if (this->exitRequested) {
+		printf("Program will terminate at the end of next generation.\n");
+		std::cout.flush();
+	}
+}
+
+bool ControlChannel::waitKey(char& key)
+{
+	while (!this->stopping) {
+#ifdef _WIN32
+		// Check the keyboard every 200 ms.
+		if (!_kbhit()) {
+			Sleep(200);
+			continue;
+		}
+		key = (char)_getch();
+#else
+		// Wait for the standard input or the wake-up pipe, at most 200 ms in
+		// case the pipe could not be created.
+		struct pollfd fds[2] = { { STDIN_FILENO, POLLIN, 0 }, { this->wakeUpPipe[0], POLLIN, 0 } };
+		if (poll(fds, 2, 200) <= 0 || !(fds[0].revents & (POLLIN | POLLHUP))) {
+			continue;
+		}
+		if (read(STDIN_FILENO, &key, 1) <= 0) {
+			// End of the standard input, no more keys.
+			return false;
+		}
+#endif
+		// [Enter] validates the key, it is not a command.
+		if (!std::isspace((unsigned char)key)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void ControlChannel::handleKey(char key)
+{
+	switch (key) {
+	case 'q':
+	case 'Q':
+		this->exitRequested = true;
+		break;
+	case 'p':
+	case 'P':
+		this->printStatsRequested = true;
+		break;
+	case 'a':
+	case 'A':
+		this->printStatsAsyncRequested = true;
+		break;
+	default:
+		printf("Invalid key '%c' pressed.", key);
+		std::cout.flush();
+	}
+}
@@ -0,0 +1,88 @@
+#ifndef CONTROL_CHANNEL_H
+#define CONTROL_CHANNEL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/**
+* \brief Keyboard commands controlling the training loop.
+*
+* A background thread waits for the keys typed on the console, without
+* consuming CPU while no key is typed, and raises the corresponding flags.
+* The training loop checks the flags between two generations.
+*
+* On POSIX systems, the thread polls the standard input and a wake-up pipe,
+* so that stop() returns without waiting for another key press. On Windows,
+* the keyboard is checked every 200 ms.
+*/
+class ControlChannel {
+protected:
+	/// Set when `q` is pressed.
+	std::atomic<bool> exitRequested;
+
+	/// Set when `p` is pressed, until taken by the training loop.
+	std::atomic<bool> printStatsRequested;
+
+	/// Set when `a` is pressed, until taken by the training loop.
+	std::atomic<bool> printStatsAsyncRequested;
+
+	/// Set by stop() to end the thread.
+	std::atomic<bool> stopping;
+
+	/// Protects ready.
+	std::mutex mutex;
+
+	/// Notified once the thread printed the available commands.
+	std::condition_variable readyCondition;
+
+	/// Whether the thread printed the available commands.
+	bool ready;
+
+#ifndef _WIN32
+	/// Pipe written by stop() to wake the thread up.
+	int wakeUpPipe[2];
+#endif
+
+	/// Thread reading the keys.
+	std::thread thread;
+
+	/// Body of the thread.
+	void run();
+
+	/**
+	* \brief Wait for a key, at most until stop() is called.
+	*
+	* \param[out] key the key pressed.
+	* \return false if no key will ever be read.
+	*/
+	bool waitKey(char& key);
+
+	/// Raise the flag of a key.
+	void handleKey(char key);
+
+public:
+	/**
+	* \brief Start the thread, and wait until it printed the available
+	* commands.
+	*/
+	ControlChannel();
+
+	/// Stop the thread.
+	~ControlChannel();
+
+	/// Stop the thread, without waiting for a key press.
+	void stop();
+
+	/// Whether `q` was pressed.
+	bool isExitRequested() const { return exitRequested; }
+
+	/// Whether `p` was pressed since the last call.
+	bool takePrintStats() { return printStatsRequested.exchange(false); }
+
+	/// Whether `a` was pressed since the last call.
+	bool takePrintStatsAsync() { return printStatsAsyncRequested.exchange(false); }
+};
+
+#endif
@@ -8,38 +8,10 @@
 #include <gegelati.h>
 
 #include "mnist.h"
+#include "controlChannel.h"
+#include "asyncDotExporter.h"
 
-void getKey(std::atomic<bool>& exit, std::atomic<bool>& printStats) {
-	std::cout << std::endl;
-	std::cout << "Press `q` then [Enter] to exit." << std::endl;
-	std::cout << "Press `p` then [Enter] to print classification statistics of the best root." << std::endl;
-	std::cout.flush();
-
-	exit = false;
-
-	while (!exit) {
-		char c;
-		std::cin >> c;
-		switch (c) {
-		case 'q':
-		case 'Q':
-			exit = true;
-			break;
-		case 'p':
-		case 'P':
-			printStats = true;
-			break;
-		default:
-			printf("Invalid key '%c' pressed.", c);
-			std::cout.flush();
-		}
-	}
-
-	printf("Program will terminate at the end of next generation.\n");
-	std::cout.flush();
-}
-
-int main() {
+int main(int argc, char** argv) {
 	std::cout << "Start MNIST application." << std::endl;
 
 	// Create the instruction set for programs
@@ -51,27 +23,34 @@ int main() {
 	auto max = [](double a, double b)->double {return std::max(a, b); };
 	auto ln = [](double a)->double {return std::log(a); };
 	auto exp = [](double a)->double {return std::exp(a); };
-	auto multByConst = [](double a, Data::Constant c)->double {return a * (double)c / 10.0; };
-	auto sobelMagn = [](const double a[3][3])->double {
-		double result = 0.0;
-		double gx =
+	auto multByConst = [](double a, Data::Constant c)->double {return a * (double)c / 10; };
+#ifdef MNIST_FLOAT32
+	// Registers are double, only the data sources are float.
+	auto minusReal = [](MNISTReal a, MNISTReal b)->double {return (double)a - (double)b; };
+	auto addReal = [](MNISTReal a, MNISTReal b)->double {return (double)a + (double)b; };
+	auto multByConstReal = [](MNISTReal a, Data::Constant c)->double {return (double)a * (double)c / 10; };
+	auto castReal = [](MNISTReal a)->double {return (double)a; };
+#endif // MNIST_FLOAT32
+	auto sobelMagn = [](const MNISTReal a[3][3])->MNISTReal {
+		MNISTReal result = 0;
+		MNISTReal gx =
 			-a[0][0] + a[0][2]
-			- 2.0 * a[1][0] + 2.0 * a[1][2]
+			- 2 * a[1][0] + 2 * a[1][2]
 			- a[2][0] + a[2][2];
-		double gy = -a[0][0] - 2.0 * a[0][1] - a[0][2]
-			+ a[2][0] + 2.0 * a[2][1] + a[2][2];
-		result = sqrt(gx * gx + gy * gy);
+		MNISTReal gy = -a[0][0] - 2 * a[0][1] - a[0][2]
+			+ a[2][0] + 2 * a[2][1] + a[2][2];
+		result = std::sqrt(gx * gx + gy * gy);
 		return result;
 	};
 
-	auto sobelDir = [](const double a[3][3])->double {
-		double result = 0.0;
-		double gx =
+	auto sobelDir = [](const MNISTReal a[3][3])->MNISTReal {
+		MNISTReal result = 0;
+		MNISTReal gx =
 			-a[0][0] + a[0][2]
-			- 2.0 * a[1][0] + 2.0 * a[1][2]
+			- 2 * a[1][0] + 2 * a[1][2]
 			- a[2][0] + a[2][2];
-		double gy = -a[0][0] - 2.0 * a[0][1] - a[0][2]
-			+ a[2][0] + 2.0 * a[2][1] + a[2][2];
+		MNISTReal gy = -a[0][0] - 2 * a[0][1] - a[0][2]
+			+ a[2][0] + 2 * a[2][1] + a[2][2];
 		result = std::atan(gy / gx);
 		return result;
 	};
@@ -84,8 +63,20 @@ int main() {
 	set.add(*(new Instructions::LambdaInstruction<double>(exp)));
 	set.add(*(new Instructions::LambdaInstruction<double>(ln)));
 	set.add(*(new Instructions::LambdaInstruction<double, Data::Constant>(multByConst)));
-	set.add(*(new Instructions::LambdaInstruction<const double[3][3]>(sobelMagn)));
-	set.add(*(new Instructions::LambdaInstruction<const double[3][3]>(sobelDir)));
+#ifdef MNIST_FLOAT32
+	set.add(*(new Instructions::LambdaInstruction<MNISTReal, MNISTReal>(minusReal)));
+	set.add(*(new Instructions::LambdaInstruction<MNISTReal, MNISTReal>(addReal)));
+	set.add(*(new Instructions::LambdaInstruction<MNISTReal, Data::Constant>(multByConstReal)));
+	set.add(*(new Instructions::LambdaInstruction<MNISTReal>(castReal)));
+#endif // MNIST_FLOAT32
+#ifndef MNIST_SOBEL_PLANES
+	set.add(*(new Instructions::LambdaInstruction<const MNISTReal[3][3]>(sobelMagn)));
+	set.add(*(new Instructions::LambdaInstruction<const MNISTReal[3][3]>(sobelDir)));
+#else
+	// Sobel magnitude and direction are precomputed data sources.
+	(void)sobelMagn;
+	(void)sobelDir;
+#endif // !MNIST_SOBEL_PLANES
 
 	// Set the parameters for the learning process.
 	// (Controls mutations probability, program lengths, and graph size
@@ -93,12 +84,18 @@ int main() {
 	// Loads them from the file params.json
 	Learn::LearningParameters params;
 	File::ParametersParser::loadParametersFromJson(ROOT_DIR "/params.json", params);
-#ifdef NB_GENERATIONS
-	params.nbGenerations = NB_GENERATIONS;
+#ifdef NB_GENERATIONS
+	params.nbGenerations = NB_GENERATIONS;
 #endif // !NB_GENERATIONS
 
 	// Instantiate the LearningEnvironment
 	MNIST mnistLE;
+#ifdef MNIST_STRATIFIED_BATCH
+	mnistLE.setTrainingBatchSize(params.maxNbActionsPerEval);
+#endif // MNIST_STRATIFIED_BATCH
+#ifdef MNIST_RACING_MIN_SAMPLES
+	mnistLE.setRacing(MNIST_RACING_MIN_SAMPLES, params.maxNbActionsPerEval, params.ratioDeletedRoots);
+#endif // MNIST_RACING_MIN_SAMPLES
 
 	std::cout << "Number of threads: " << params.nbThreads << std::endl;
 
@@ -107,21 +104,27 @@ int main() {
 	la.init();
 
 	// Create an exporter for all graphs
-	File::TPGGraphDotExporter dotExporter("out_0000.dot", *la.getTPGGraph());
+	// (checkpoint period and rotation can be set with -dotPeriod and -dotKept)
+	uint64_t dotPeriod = 1;
+	size_t dotNbKept = 0;
+	AsyncDotExporter::parseCommandLine(argc, argv, dotPeriod, dotNbKept);
+	AsyncDotExporter dotExporter(*la.getTPGGraph(), dotPeriod, dotNbKept);
 
 	// Start a thread for controlling the loop
 #ifndef NO_CONSOLE_CONTROL
-	std::atomic<bool> exitProgram = true; // (set to false by other thread) 
-	std::atomic<bool> printStats = false;
-
-	std::thread threadKeyboard(getKey, std::ref(exitProgram), std::ref(printStats));
-
-	while (exitProgram); // Wait for other thread to print key info.
+	ControlChannel control;
+	auto exitProgram = [&control]() { return control.isExitRequested(); };
+	auto printStats = [&control]() { return control.takePrintStats(); };
+	auto printStatsAsync = [&control]() { return control.takePrintStatsAsync(); };
 #else 
-	std::atomic<bool> exitProgram = false; // (set to false by other thread) 
-	std::atomic<bool> printStats = false;
+	auto exitProgram = []() { return false; };
+	auto printStats = []() { return false; };
+	auto printStatsAsync = []() { return false; };
 #endif
 
+	// Statistics printed in background while the training continues
+	std::future<void> asyncStats;
+
 	// Adds a logger to the LA (to get statistics on learning) on std::cout
 	Log::LABasicLogger logCout(la);
 
@@ -136,20 +139,33 @@ int main() {
 	File::ParametersParser::writeParametersToJson("exported_params.json", params);
 
 	// Train for NB_GENERATIONS generations
-	for (int i = 0; i < params.nbGenerations && !exitProgram; i++) {
+	for (int i = 0; i < params.nbGenerations && !exitProgram(); i++) {
 		char buff[13];
 		sprintf(buff, "out_%04d.dot", i);
-		dotExporter.setNewFilePath(buff);
-		dotExporter.print();
+		dotExporter.checkpoint(i, buff);
 
 		la.trainOneGeneration(i);
 
-		if (printStats) {
-			mnistLE.printClassifStatsTable(la.getTPGGraph()->getEnvironment(), la.getBestRoot().first);
-			printStats = false;
+		if (printStats()) {
+			mnistLE.printClassifStatsTable(la.getTPGGraph()->getEnvironment(), la.getBestRoot().first, params.nbThreads);
+		}
+
+		if (printStatsAsync()) {
+			// Only one background evaluation at a time.
+			if (!asyncStats.valid() || asyncStats.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+				asyncStats = mnistLE.printClassifStatsTableAsync(la.getTPGGraph()->getEnvironment(), la.getBestRoot().first, params.nbThreads);
+			}
 		}
 	}
 
+	// Wait for the statistics printed in background
+	if (asyncStats.valid()) {
+		asyncStats.wait();
+	}
+
+	// Wait for the checkpoints, they share their programs with the graph.
+	dotExporter.flush();
+
 	// Keep best policy
 	la.keepBestPolicy();
 
@@ -157,8 +173,8 @@ int main() {
 	la.getTPGGraph()->clearProgramIntrons();
 
 	// Export the graph
-	dotExporter.setNewFilePath("out_best.dot");
-	dotExporter.print();
+	dotExporter.exportGraph("out_best.dot");
+	dotExporter.flush();
 
 	TPG::PolicyStats ps;
 	ps.setEnvironment(la.getTPGGraph()->getEnvironment());
@@ -172,7 +188,7 @@ int main() {
 	stats.close();
 
 	// Print stats one last time
-	mnistLE.printClassifStatsTable(la.getTPGGraph()->getEnvironment(), la.getTPGGraph()->getRootVertices().at(0));
+	mnistLE.printClassifStatsTable(la.getTPGGraph()->getEnvironment(), la.getTPGGraph()->getRootVertices().at(0), params.nbThreads);
 
 	// cleanup
 	for (unsigned int i = 0; i < set.getNbInstructions(); i++) {
@@ -181,8 +197,7 @@ int main() {
 
 #ifndef NO_CONSOLE_CONTROL
 	// Exit the thread
-	std::cout << "Exiting program, press a key then [enter] to exit if nothing happens.";
-	threadKeyboard.join();
+	control.stop();
 #endif
 
 	return 0;
@@ -1,50 +1,124 @@
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <thread>
 #include <random>
 #include <inttypes.h>
 
 #include "mnist.h"
 
-mnist::MNIST_dataset<std::vector, std::vector<double>, uint8_t> MNIST::dataset(mnist::read_dataset<std::vector, std::vector, double, uint8_t>(MNIST_DATA_LOCATION));
+#ifdef MNIST_SOBEL_PLANES
+static const bool WITH_SOBEL_PLANES = true;
+#else
+static const bool WITH_SOBEL_PLANES = false;
+#endif // MNIST_SOBEL_PLANES
 
-void MNIST::changeCurrentImage()
+const MNISTDataset& MNIST::getDataset()
 {
-	// Get the container for the current mode.
-	std::vector<std::vector<double>>& dataSource = (this->currentMode == Learn::LearningMode::TRAINING) ?
-		this->dataset.training_images : this->dataset.test_images;
+	static const MNISTDataset dataset(MNIST_DATA_LOCATION, WITH_SOBEL_PLANES);
+	return dataset;
+}
+
+const std::vector<uint64_t>& MNIST::getSampleOrder(Learn::LearningMode mode)
+{
+	auto sequence = [](size_t size) {
+		std::vector<uint64_t> order(size);
+		std::iota(order.begin(), order.end(), 0);
+		return order;
+	};
+	// Draw a permutation with a fixed seed (Fisher-Yates shuffle)
+	auto shuffle = [&sequence](size_t size, size_t seed) {
+		std::vector<uint64_t> order = sequence(size);
+		Mutator::RNG orderRng(seed);
+		for (size_t i = size; i > 1; i--) {
+			std::swap(order[i - 1], order[orderRng.getUnsignedInt64(0, i - 1)]);
+		}
+		return order;
+	};
+	static const std::vector<uint64_t> trainingOrder = shuffle(getDataset().training.size(), 0);
+	static const std::vector<uint64_t> validationOrder = shuffle(getDataset().test.size(), 1);
+	static const std::vector<uint64_t> testingOrder = sequence(getDataset().test.size());
 
-	// Select the image 
-	// If the mode is training or validation
-	if (this->currentMode == Learn::LearningMode::TRAINING || this->currentMode == Learn::LearningMode::VALIDATION) {
-		// Select a random image index
-		this->currentIndex = rng.getUnsignedInt64(0, dataSource.size() - 1);
+	switch (mode) {
+	case Learn::LearningMode::TRAINING:
+		return trainingOrder;
+	case Learn::LearningMode::VALIDATION:
+		return validationOrder;
+	default:
+		return testingOrder;
 	}
-	else {
-		// If the mode is TESTING, just go to the next image
-		this->currentIndex = (this->currentIndex + 1) % dataSource.size();
+}
+
+void MNIST::changeCurrentImage()
+{
+	// Go to the next image of the order.
+	this->currentPosition++;
+	if (this->currentPosition == this->currentSplit->size()) {
+		this->currentPosition = 0;
 	}
+	this->currentIndex = this->currentOrder[this->currentPosition];
 
 	// Load the image in the dataSource
-	for (uint64_t pxlIndex = 0; pxlIndex < 28 * 28; pxlIndex++) {
-		this->currentImage.setPointer(&dataSource.at(this->currentIndex));
+	const MNISTPixel* image = this->currentSplit->getImage(this->currentIndex);
+	std::copy(image, image + MNISTSplit::IMAGE_SIZE, this->currentImageData.begin());
+
+	// Load its feature planes
+	const MNISTFeaturePlanes* features = this->currentSplit->getFeatures();
+	if (features != NULL) {
+		const float* magnitude = features->getPlane(this->currentIndex, MNISTFeaturePlanes::SOBEL_MAGNITUDE);
+		std::copy(magnitude, magnitude + MNISTFeaturePlanes::PLANE_SIZE, this->currentSobelMagnitudeData.begin());
+		const float* direction = features->getPlane(this->currentIndex, MNISTFeaturePlanes::SOBEL_DIRECTION);
+		std::copy(direction, direction + MNISTFeaturePlanes::PLANE_SIZE, this->currentSobelDirectionData.begin());
 	}
 
 	// Keep current label too.
-	this->currentClass = (this->currentMode == Learn::LearningMode::TRAINING) ?
-		this->dataset.training_labels.at(this->currentIndex) : this->dataset.test_labels.at(this->currentIndex);
+	this->currentClass = this->currentSplit->getLabel(this->currentIndex);
+}
+
+MNIST::MNIST() : ClassificationLearningEnvironment(10), currentSplit(&getDataset().training),
+	currentImage(MNISTSplit::IMAGE_WIDTH, MNISTSplit::IMAGE_HEIGHT), currentImageData(MNISTSplit::IMAGE_SIZE, (MNISTReal)0),
+	currentSobelMagnitude(MNISTFeaturePlanes::PLANE_WIDTH, MNISTFeaturePlanes::PLANE_HEIGHT), currentSobelMagnitudeData(MNISTFeaturePlanes::PLANE_SIZE, (MNISTReal)0),
+	currentSobelDirection(MNISTFeaturePlanes::PLANE_WIDTH, MNISTFeaturePlanes::PLANE_HEIGHT), currentSobelDirectionData(MNISTFeaturePlanes::PLANE_SIZE, (MNISTReal)0),
+	currentIndex(0), currentOrder(getSampleOrder(Learn::LearningMode::TRAINING).data()), currentPosition(0),
+	currentGeneration(0), raceCutoff(0.0), nbSamples(0), nbCorrect(0), raceLost(false)
+{
+	this->currentImage.setPointer(&this->currentImageData);
+	this->currentSobelMagnitude.setPointer(&this->currentSobelMagnitudeData);
+	this->currentSobelDirection.setPointer(&this->currentSobelDirectionData);
 
+	const MNISTDataset& dataset = getDataset();
+	std::cout << "Nbr of training images = " << dataset.training.size() << std::endl;
+	std::cout << "Nbr of test images = " << dataset.test.size() << std::endl;
+	std::cout << "Dataset size = " << (dataset.training.getMemorySize() + dataset.test.getMemorySize()) / 1024 << " KB ("
+		<< sizeof(MNISTPixel) << " byte(s) per pixel)" << std::endl;
 }
 
-MNIST::MNIST() : ClassificationLearningEnvironment(10), currentImage(28, 28)
+MNIST::MNIST(const MNIST& other) : ClassificationLearningEnvironment(other), currentSplit(other.currentSplit),
+	currentMode(other.currentMode), rng(other.rng), currentImage(other.currentImage),
+	currentImageData(other.currentImageData),
+	currentSobelMagnitude(other.currentSobelMagnitude), currentSobelMagnitudeData(other.currentSobelMagnitudeData),
+	currentSobelDirection(other.currentSobelDirection), currentSobelDirectionData(other.currentSobelDirectionData),
+	currentIndex(other.currentIndex),
+	currentOrder(other.currentOrder), currentPosition(other.currentPosition),
+	batchCache(other.batchCache), currentBatch(other.currentBatch),
+	race(other.race), currentGeneration(other.currentGeneration), raceCutoff(other.raceCutoff),
+	nbSamples(other.nbSamples), nbCorrect(other.nbCorrect), raceLost(other.raceLost)
 {
-	// Fill shared dataset dataset(mnist::read_dataset<std::vector, std::vector, double, uint8_t>(MNIST_DATA_LOCATION))
-	if (MNIST::dataset.training_labels.size() != 0) {
-		std::cout << "Nbr of training images = " << dataset.training_images.size() << std::endl;
-		std::cout << "Nbr of training labels = " << dataset.training_labels.size() << std::endl;
-		std::cout << "Nbr of test images = " << dataset.test_images.size() << std::endl;
-		std::cout << "Nbr of test labels = " << dataset.test_labels.size() << std::endl;
-	}
-	else {
-		throw std::runtime_error("Initialization of MNIST databased failed.");
-	}
+	this->currentImage.setPointer(&this->currentImageData);
+	this->currentSobelMagnitude.setPointer(&this->currentSobelMagnitudeData);
+	this->currentSobelDirection.setPointer(&this->currentSobelDirectionData);
+}
+
+void MNIST::setTrainingBatchSize(size_t batchSize)
+{
+	this->batchCache = (batchSize == 0) ? NULL : std::make_shared<MNISTBatchCache>(getDataset().training, batchSize);
+	this->currentBatch = NULL;
+	this->reset(0, Learn::LearningMode::TRAINING);
+}
+
+void MNIST::setRacing(uint64_t minNbSamples, uint64_t nbSamplesPerEval, double ratioDeletedRoots)
+{
+	this->race = (minNbSamples == 0) ? NULL : std::make_shared<MNISTRace>(minNbSamples, nbSamplesPerEval, ratioDeletedRoots);
 }
 
 void MNIST::doAction(uint64_t actionID)
@@ -52,7 +126,35 @@ void MNIST::doAction(uint64_t actionID)
 	// Call to devault method to increment classificationTable
 	ClassificationLearningEnvironment::doAction(actionID);
 
+	this->nbSamples++;
+	if (actionID == this->currentClass) {
+		this->nbCorrect++;
+	}
+
 	this->changeCurrentImage();
+
+	if (this->race != NULL && this->currentMode == Learn::LearningMode::TRAINING) {
+		if (this->race->isLost(this->nbCorrect, this->nbSamples, this->raceCutoff)) {
+			this->loseRace();
+		}
+		if (this->nbSamples == this->race->getNbSamplesPerEval()) {
+			this->race->addAccuracy(this->currentGeneration, (double)this->nbCorrect / (double)this->nbSamples);
+		}
+	}
+}
+
+void MNIST::loseRace()
+{
+	// Misclassify the remaining samples, in the order they would be presented.
+	uint64_t nbRemaining = this->race->getNbSamplesPerEval() - this->nbSamples;
+	uint64_t position = this->currentPosition;
+	for (uint64_t i = 0; i < nbRemaining; i++) {
+		uint64_t label = this->currentSplit->getLabel(this->currentOrder[position]);
+		this->classificationTable[label][(label + 1) % 10]++;
+		position = (position + 1 == this->currentSplit->size()) ? 0 : position + 1;
+	}
+	this->nbSamples += nbRemaining;
+	this->raceLost = true;
 }
 
 void MNIST::reset(size_t seed, Learn::LearningMode mode, uint16_t iterationNumber, uint64_t generationNumber)
@@ -63,14 +165,47 @@ void MNIST::reset(size_t seed, Learn::LearningMode mode, uint16_t iterationNumbe
 	this->currentMode = mode;
 	this->rng.setSeed(seed);
 
-	// Reset at -1 so that in TESTING mode, first value tested is 0.
-	this->currentIndex = -1;
+	// Race against the roots evaluated in the previous generation
+	this->currentGeneration = generationNumber;
+	this->raceCutoff = (this->race != NULL && mode == Learn::LearningMode::TRAINING) ? this->race->getCutoff(generationNumber) : 0.0;
+	this->nbSamples = 0;
+	this->nbCorrect = 0;
+	this->raceLost = false;
+
+	// Present the stratified batch of the seed, from its first image.
+	if (mode == Learn::LearningMode::TRAINING && this->batchCache != NULL) {
+		this->currentBatch = this->batchCache->getBatch(seed);
+		this->currentSplit = this->currentBatch.get();
+		this->currentOrder = this->batchCache->getBatchOrder().data();
+		this->startAt(0);
+		return;
+	}
+
+	this->currentBatch = NULL;
+	this->currentSplit = (mode == Learn::LearningMode::TRAINING) ? &getDataset().training : &getDataset().test;
+	this->currentOrder = getSampleOrder(mode).data();
+
+	// Start at a random position of the order in TRAINING and VALIDATION
+	// modes, at the first image in TESTING mode.
+	uint64_t start = (mode == Learn::LearningMode::TESTING) ? 0 : rng.getUnsignedInt64(0, this->currentSplit->size() - 1);
+	this->startAt(start);
+}
+
+void MNIST::startAt(uint64_t position)
+{
+	// changeCurrentImage() moves to the next position.
+	uint64_t nbImages = this->currentSplit->size();
+	this->currentPosition = (position + nbImages - 1) % nbImages;
 	this->changeCurrentImage();
 }
 
 std::vector<std::reference_wrapper<const Data::DataHandler>> MNIST::getDataSources()
 {
 	std::vector<std::reference_wrapper<const Data::DataHandler>> res = { currentImage };
+	if (getDataset().training.getFeatures() != NULL) {
+		res.push_back(currentSobelMagnitude);
+		res.push_back(currentSobelDirection);
+	}
 
 	return res;
 }
@@ -93,7 +228,7 @@ double MNIST::getScore() const
 
 bool MNIST::isTerminal() const
 {
-	return false;
+	return this->raceLost;
 }
 
 uint8_t MNIST::getCurrentImageLabel()
@@ -101,53 +236,142 @@ uint8_t MNIST::getCurrentImageLabel()
 	return (uint8_t)this->currentClass;
 }
 
-void MNIST::printClassifStatsTable(const Environment& env, const TPG::TPGVertex* bestRoot) {
-	// Print table of classif of the best
-	TPG::TPGExecutionEngine tee(env, NULL);
+MNIST::ConfusionMatrix MNIST::computeConfusionMatrix(const Environment& env, const TPG::TPGVertex* root, size_t nbThreads) const
+{
+	const uint64_t nbImages = getDataset().test.size();
+	nbThreads = std::max<size_t>(1, std::min<size_t>(nbThreads, nbImages));
 
-	// Change the MODE of mnist
-	this->reset(0, Learn::LearningMode::TESTING);
+	// Classify the images of a shard and fill its confusion matrix.
+	auto classifyShard = [this, &env, root, nbImages, nbThreads](size_t shard, ConfusionMatrix& classifTable) {
+		uint64_t first = shard * nbImages / nbThreads;
+		uint64_t last = (shard + 1) * nbImages / nbThreads;
 
-	// Fill the table
-	uint64_t classifTable[10][10] = { 0 };
-	uint64_t nbPerClass[10] = { 0 };
+		// Private copy of the LearningEnvironment, and of the Environment
+		// wrapping its data sources.
+		MNIST privateLE(*this);
+		Environment privateEnv(env.getInstructionSet(), privateLE.getDataSources(), env.getNbRegisters(), env.getNbConstant());
+		TPG::TPGExecutionEngine tee(privateEnv, NULL);
+
+		// Change the MODE of mnist
+		privateLE.reset(0, Learn::LearningMode::TESTING);
+		privateLE.startAt(first);
 
-	const int TOTAL_NB_IMAGE = 10000;
-	for (int nbImage = 0; nbImage < TOTAL_NB_IMAGE; nbImage++) {
-		// Get answer
-		uint8_t currentLabel = this->getCurrentImageLabel();
-		nbPerClass[currentLabel]++;
+		for (uint64_t nbImage = first; nbImage < last; nbImage++) {
+			// Get answer
+			uint8_t currentLabel = privateLE.getCurrentImageLabel();
 
-		// Execute
-		auto path = tee.executeFromRoot(*bestRoot);
-		const TPG::TPGAction* action = (const TPG::TPGAction*)path.at(path.size() - 1);
-		uint8_t actionID = (uint8_t)action->getActionID();
+			// Execute
+			auto path = tee.executeFromRoot(*root);
+			const TPG::TPGAction* action = (const TPG::TPGAction*)path.at(path.size() - 1);
+			uint8_t actionID = (uint8_t)action->getActionID();
 
-		// Increment table
-		classifTable[currentLabel][actionID]++;
+			// Increment table
+			classifTable[currentLabel][actionID]++;
 
-		// Do action (to trigger image update)
-		this->doAction(action->getActionID());
+			// Do action (to trigger image update)
+			privateLE.doAction(action->getActionID());
+		}
+	};
+
+	std::vector<ConfusionMatrix> shardTables(nbThreads, ConfusionMatrix{});
+	std::vector<std::thread> threads;
+	for (size_t shard = 1; shard < nbThreads; shard++) {
+		threads.emplace_back(classifyShard, shard, std::ref(shardTables[shard]));
+	}
+	classifyShard(0, shardTables[0]);
+	for (std::thread& thread : threads) {
+		thread.join();
 	}
 
-	// Print the table
-	printf("\t");
+	// Merge the tables
+	ConfusionMatrix classifTable{};
+	for (const ConfusionMatrix& shardTable : shardTables) {
+		for (int i = 0; i < 10; i++) {
+			for (int j = 0; j < 10; j++) {
+				classifTable[i][j] += shardTable[i][j];
+			}
+		}
+	}
+	return classifTable;
+}
+
+void MNIST::printConfusionMatrix(const ConfusionMatrix& classifTable)
+{
+	uint64_t nbPerClass[10] = { 0 };
 	for (int i = 0; i < 10; i++) {
-		printf("%d\t", i);
+		for (int j = 0; j < 10; j++) {
+			nbPerClass[i] += classifTable[i][j];
+		}
 	}
-	printf("Nb\n");
+
+	// Format the whole table before printing it, so that it is not mixed
+	// with the outputs of other threads.
+	std::string table;
+	char buffer[32];
+	table += "\t";
+	for (int i = 0; i < 10; i++) {
+		snprintf(buffer, sizeof(buffer), "%d\t", i);
+		table += buffer;
+	}
+	table += "Nb\n";
 	for (int i = 0; i < 10; i++) {
-		printf("%d\t", i);
+		snprintf(buffer, sizeof(buffer), "%d\t", i);
+		table += buffer;
 		for (int j = 0; j < 10; j++) {
 			if (i == j) {
-				printf("\033[0;32m");
+				table += "\033[0;32m";
 			}
-			printf("%2.1f\t", 100.0 * (double)classifTable[i][j] / (double)nbPerClass[i]);
+			snprintf(buffer, sizeof(buffer), "%2.1f\t", 100.0 * (double)classifTable[i][j] / (double)nbPerClass[i]);
+			table += buffer;
 			if (i == j) {
-				printf("\033[0m");
+				table += "\033[0m";
+			}
+		}
+		snprintf(buffer, sizeof(buffer), "%4" PRIu64 "\n", nbPerClass[i]);
+		table += buffer;
+	}
+	std::cout << table << std::endl;
+}
+
+void MNIST::printClassifStatsTable(const Environment& env, const TPG::TPGVertex* bestRoot, size_t nbThreads) {
+	// Print table of classif of the best
+	printConfusionMatrix(this->computeConfusionMatrix(env, bestRoot, nbThreads));
+
+	// Leave the LearningEnvironment in TESTING mode, as the sequential
+	// classification did.
+	this->reset(0, Learn::LearningMode::TESTING);
+}
+
+std::future<void> MNIST::printClassifStatsTableAsync(const Environment& env, const TPG::TPGVertex* bestRoot, size_t nbThreads) const
+{
+	// Copy the policy of the root in a separate graph, vertices are numbered
+	// in the order they are first reached.
+	std::shared_ptr<TPG::TPGGraph> snapshot = std::make_shared<TPG::TPGGraph>(env);
+	std::map<const TPG::TPGVertex*, const TPG::TPGVertex*> copies;
+	std::vector<const TPG::TPGVertex*> toCopy{ bestRoot };
+	for (size_t i = 0; i < toCopy.size(); i++) {
+		const TPG::TPGVertex* vertex = toCopy[i];
+		const TPG::TPGAction* action = dynamic_cast<const TPG::TPGAction*>(vertex);
+		copies[vertex] = (action != NULL) ? (const TPG::TPGVertex*)&snapshot->addNewAction(action->getActionID())
+			: (const TPG::TPGVertex*)&snapshot->addNewTeam();
+		for (const TPG::TPGEdge* edge : vertex->getOutgoingEdges()) {
+			if (std::find(toCopy.begin(), toCopy.end(), edge->getDestination()) == toCopy.end()) {
+				toCopy.push_back(edge->getDestination());
 			}
 		}
-		printf("%4" PRIu64 "\n", nbPerClass[i]);
 	}
-	std::cout << std::endl;
+	for (const TPG::TPGVertex* vertex : toCopy) {
+		for (const TPG::TPGEdge* edge : vertex->getOutgoingEdges()) {
+			// Programs are never modified once in the graph, they are shared.
+			snapshot->addNewEdge(*copies[vertex], *copies[edge->getDestination()], edge->getProgramSharedPointer());
+		}
+	}
+	const TPG::TPGVertex* snapshotRoot = copies[bestRoot];
+
+	// The LearningEnvironment may be used by the training meanwhile.
+	std::shared_ptr<MNIST> privateLE = std::make_shared<MNIST>(*this);
+
+	return std::async(std::launch::async, [privateLE, snapshot, snapshotRoot, &env, nbThreads]() {
+		printConfusionMatrix(privateLE->computeConfusionMatrix(env, snapshotRoot, nbThreads));
+	});
 }
@@ -1,19 +1,38 @@
 #ifndef MNIST_H
 #define MNIST_H
 
+#include <array>
+#include <future>
 #include <random>
 
 #include <gegelati.h>
 
-#include "mnist_reader/mnist_reader.hpp"
+#include "mnistDataset.h"
+#include "mnistFeatures.h"
+#include "mnistRacing.h"
+
+#ifdef MNIST_FLOAT32
+/// Type of the data sources, and of the operands of the instructions reading them.
+typedef float MNISTReal;
+#else
+/// Type of the data sources, and of the operands of the instructions reading them.
+typedef double MNISTReal;
+#endif // MNIST_FLOAT32
 
 /**
 * LearningEnvironment to train an agent to classify the MNIST database.
 */
 class MNIST : public Learn::ClassificationLearningEnvironment {
 protected:
-	/// MNIST dataset for the training.
-	static mnist::MNIST_dataset<std::vector, std::vector<double>, uint8_t> dataset;
+	/**
+	* \brief Get the MNIST dataset shared by all the LearningEnvironments.
+	*
+	* The dataset is loaded on the first call.
+	*/
+	static const MNISTDataset& getDataset();
+
+	/// Split of the dataset for the current mode.
+	const MNISTSplit* currentSplit;
 
 	/// Current LearningMode of the LearningEnvironment.
 	Learn::LearningMode currentMode;
@@ -22,19 +41,87 @@ protected:
 	Mutator::RNG rng;
 
 	/// Current image provided to the LearningAgent
-	Data::Array2DWrapper<double> currentImage;
+	Data::Array2DWrapper<MNISTReal> currentImage;
+
+	/// Pixels of the current image, converted from the dataset.
+	std::vector<MNISTReal> currentImageData;
+
+	/// Sobel magnitude plane of the current image.
+	Data::Array2DWrapper<MNISTReal> currentSobelMagnitude;
+
+	/// Values of currentSobelMagnitude, converted from the dataset.
+	std::vector<MNISTReal> currentSobelMagnitudeData;
+
+	/// Sobel direction plane of the current image.
+	Data::Array2DWrapper<MNISTReal> currentSobelDirection;
+
+	/// Values of currentSobelDirection, converted from the dataset.
+	std::vector<MNISTReal> currentSobelDirectionData;
 
 	/// Current index of the image in the dataset.
 	uint64_t currentIndex;
 
+	/// Order in which the images of currentSplit are presented.
+	const uint64_t* currentOrder;
+
+	/// Position of the current image in currentOrder.
+	uint64_t currentPosition;
+
+	/// Stratified training batches, shared by the clones of the
+	/// LearningEnvironment. NULL when TRAINING uses the whole split.
+	std::shared_ptr<MNISTBatchCache> batchCache;
+
+	/// Batch of the current TRAINING evaluation, kept alive while in use.
+	std::shared_ptr<const MNISTSplit> currentBatch;
+
+	/// Race between TRAINING evaluations, shared by the clones of the
+	/// LearningEnvironment. NULL when evaluations always run to the end.
+	std::shared_ptr<MNISTRace> race;
+
+	/// Generation of the current evaluation.
+	uint64_t currentGeneration;
+
+	/// Survival cutoff of the current evaluation, 0 outside of races.
+	double raceCutoff;
+
+	/// Number of samples classified since the last reset.
+	uint64_t nbSamples;
+
+	/// Number of samples correctly classified since the last reset.
+	uint64_t nbCorrect;
+
+	/// Whether the current evaluation lost the race.
+	bool raceLost;
+
+	/**
+	* \brief Stop the current evaluation, which lost the race.
+	*
+	* The remaining samples of the evaluation are counted as misclassified
+	* in the classificationTable, so that the root keeps the worst score it
+	* could get with a complete evaluation.
+	*/
+	void loseRace();
+
+	/**
+	* \brief Get the order in which images are presented in a mode.
+	*
+	* In TRAINING and VALIDATION modes, the order is a random permutation of
+	* the images of the split, drawn once for all the LearningEnvironments.
+	* In TESTING mode, images are presented in the order of the dataset.
+	*/
+	static const std::vector<uint64_t>& getSampleOrder(Learn::LearningMode mode);
+
 	/**
 	* \brief Change the image currently available in the dataSources of the LearningEnvironment.
 	*
-	* A random image from the dataset for the current mode is selected.
+	* The next image in the order of the current mode is selected.
 	*
 	*/
 	void changeCurrentImage();
 
+	/// Make the image at a given position of currentOrder the current one.
+	void startAt(uint64_t position);
+
 public:
 
 	/**
@@ -45,6 +132,39 @@ public:
 	*/
 	MNIST();
 
+	/**
+	* \brief Copy constructor.
+	*
+	* The currentImage and feature planes of the copy wrap their own data.
+	*/
+	MNIST(const MNIST& other);
+
+	/**
+	* \brief Evaluate TRAINING roots on a stratified mini-batch.
+	*
+	* When batchSize is not 0, each reset in TRAINING mode presents the images
+	* of a class-stratified batch of batchSize training images, drawn from
+	* the reset seed. All the roots of a generation are reset with the same
+	* seeds, and are thus scored on the same images. Each batch is copied
+	* contiguously in memory, and shared by all the clones of the
+	* LearningEnvironment created after this call.
+	*
+	* \param[in] batchSize number of images per batch, 0 to present the
+	* whole training split.
+	*/
+	void setTrainingBatchSize(size_t batchSize);
+
+	/**
+	* \brief Stop the TRAINING evaluations that can no longer reach the
+	* survival cutoff of the generation.
+	*
+	* \param[in] minNbSamples number of samples classified before an
+	* evaluation can be stopped, 0 to disable the race.
+	* \param[in] nbSamplesPerEval maxNbActionsPerEval of the LearningAgent.
+	* \param[in] ratioDeletedRoots ratioDeletedRoots of the LearningAgent.
+	*/
+	void setRacing(uint64_t minNbSamples, uint64_t nbSamplesPerEval, double ratioDeletedRoots);
+
 	/// Inherited via LearningEnvironment
 	virtual void doAction(uint64_t actionID) override;
 
@@ -52,7 +172,12 @@ public:
 	virtual void reset(size_t seed = 0, Learn::LearningMode mode = Learn::LearningMode::TRAINING,
 					   uint16_t iterationNumber = 0, uint64_t generationNumber = 0) override;
 
-	/// Inherited via LearningEnvironment
+	/**
+	* \brief Get the data sources of the LearningEnvironment.
+	*
+	* The current image, followed by its Sobel magnitude and direction planes
+	* when the application is built with MNIST_SOBEL_PLANES.
+	*/
 	virtual std::vector<std::reference_wrapper<const Data::DataHandler>> getDataSources() override;
 
 	/// Inherited via LearningEnvironment
@@ -76,10 +201,8 @@ public:
 	virtual double getScore() const override;
 
 	/**
-	* \brief This classification LearningEnvironment will never reach a
-	* terminal state.
-	*
-	* \return false.
+	* \brief This classification LearningEnvironment only reaches a terminal
+	* state when its evaluation lost the race.
 	*/
 	virtual bool isTerminal() const override;
 
@@ -90,13 +213,50 @@ public:
 	*/
 	uint8_t getCurrentImageLabel();
 
+	/// Number of images of each class (row) classified in each action (column).
+	typedef std::array<std::array<uint64_t, 10>, 10> ConfusionMatrix;
+
+	/**
+	* \brief Classify the test images with a root.
+	*
+	* The test set is split in nbThreads contiguous shards. Each shard is
+	* classified by its own thread, with its own clone of the
+	* LearningEnvironment and TPGExecutionEngine. The confusion matrices of
+	* all the shards are then summed.
+	*
+	* \param[in] env the Environment of the TPGGraph of the root.
+	* \param[in] root the root to evaluate.
+	* \param[in] nbThreads number of threads used for the evaluation.
+	*/
+	ConfusionMatrix computeConfusionMatrix(const Environment& env, const TPG::TPGVertex* root, size_t nbThreads = 1) const;
+
+	/// Print a confusion matrix, with the percentage of each class per action.
+	static void printConfusionMatrix(const ConfusionMatrix& classifTable);
+
 	/**
 	* \brief Function printing the statistics of the classification.
 	*
-	* \param[in] result the Map containing the list of roots within a TPGGraph,
-	* with their score in ascending order.
+	* \param[in] env the Environment of the TPGGraph of the root.
+	* \param[in] bestRoot the root to evaluate.
+	* \param[in] nbThreads number of threads used for the evaluation.
+	*/
+	void printClassifStatsTable(const Environment& env, const TPG::TPGVertex* bestRoot, size_t nbThreads = 1);
+
+	/**
+	* \brief Print the statistics of the classification from a background
+	* thread, while the training continues.
+	*
+	* The policy of the root is copied in a separate TPGGraph before the
+	* function returns, so that the TPGGraph of the root can be modified by
+	* the training meanwhile. Programs are shared with the copy, the
+	* LearningAgent owning env must outlive the returned future.
+	*
+	* \param[in] env the Environment of the TPGGraph of the root.
+	* \param[in] bestRoot the root to evaluate.
+	* \param[in] nbThreads number of threads used for the evaluation.
+	* \return a future to wait for the end of the evaluation.
 	*/
-	void printClassifStatsTable(const Environment& env, const TPG::TPGVertex* bestRoot);
+	std::future<void> printClassifStatsTableAsync(const Environment& env, const TPG::TPGVertex* bestRoot, size_t nbThreads = 1) const;
 };
 
 #endif
@@ -0,0 +1,434 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <process.h>
+#define getpid _getpid
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "mnist_reader/mnist_reader.hpp"
+
+#include "fnv1a.h"
+#include "mnistDataset.h"
+#include "mnistFeatures.h"
+
+/**
+* Header of the binary cache file.
+*
+* The header is followed by the pixels and the labels of the training split,
+* then of the test split, each array starting on a MNISTSplit::ALIGNMENT
+* boundary.
+*/
+struct MNISTCacheHeader {
+	char magic[8];
+	uint32_t version;
+	/// sizeof(MNISTPixel)
+	uint32_t pixelSize;
+	/// Whether MNISTPixel is a floating point type.
+	uint32_t pixelIsFloat;
+	/// Pixels between two images.
+	uint32_t imageStride;
+	/// Size of the 4 idx files the cache was written from.
+	uint64_t sourceSizes[4];
+	/// Last modification time of the 4 idx files, in seconds.
+	int64_t sourceMTimes[4];
+	/// 64-bit FNV-1a hash of the content of the 4 idx files, 0 when not
+	/// computed yet.
+	uint64_t sourceHashes[4];
+	uint64_t nbImages[2];
+	uint64_t pixelsOffset[2];
+	uint64_t labelsOffset[2];
+	uint64_t fileSize;
+};
+
+static const char CACHE_MAGIC[8] = { 'G', 'G', 'M', 'N', 'I', 'S', 'T', '\0' };
+static const uint32_t CACHE_VERSION = 3;
+
+static const char* IDX_FILES[4] = {
+	"/train-images-idx3-ubyte", "/train-labels-idx1-ubyte",
+	"/t10k-images-idx3-ubyte", "/t10k-labels-idx1-ubyte" };
+
+/// Get the size and the modification time of a file, or 0 if it can not be
+/// read.
+static void getFileStat(const std::string& path, uint64_t& size, int64_t& mtime)
+{
+#ifdef _WIN32
+	struct _stat64 fileStat;
+	bool found = _stat64(path.c_str(), &fileStat) == 0;
+#else
+	struct stat fileStat;
+	bool found = stat(path.c_str(), &fileStat) == 0;
+#endif
+	size = found ? (uint64_t)fileStat.st_size : 0;
+	mtime = found ? (int64_t)fileStat.st_mtime : 0;
+}
+
+/// Get the FNV-1a hash of the content of a file, or 0 if it can not be opened.
+static uint64_t getFileHash(const std::string& path)
+{
+	uint64_t hash = FNV1A_OFFSET_BASIS;
+	return fnv1aFile(path, hash) ? hash : 0;
+}
+
+/// Round an offset up to the alignment of the images.
+static uint64_t alignOffset(uint64_t offset)
+{
+	return (offset + MNISTSplit::ALIGNMENT - 1) / MNISTSplit::ALIGNMENT * MNISTSplit::ALIGNMENT;
+}
+
+/**
+* Fill the fields of the header that do not depend on the splits.
+*
+* Only the size and the modification time of the idx files are read, their
+* content is hashed by hashCacheSources() when they do not match the cache.
+*/
+static void initCacheHeader(MNISTCacheHeader& header, const std::string& folder)
+{
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	header.version = CACHE_VERSION;
+	header.pixelSize = sizeof(MNISTPixel);
+	header.pixelIsFloat = std::is_floating_point<MNISTPixel>::value;
+	header.imageStride = (uint32_t)MNISTSplit::getAlignedImageStride();
+	for (int i = 0; i < 4; i++) {
+		getFileStat(folder + IDX_FILES[i], header.sourceSizes[i], header.sourceMTimes[i]);
+	}
+}
+
+/// Hash the content of the idx files in the header, unless already done.
+static void hashCacheSources(MNISTCacheHeader& header, const std::string& folder)
+{
+	for (int i = 0; i < 4; i++) {
+		if (header.sourceHashes[i] == 0) {
+			header.sourceHashes[i] = getFileHash(folder + IDX_FILES[i]);
+		}
+	}
+}
+
+size_t MNISTSplit::getAlignedImageStride()
+{
+	size_t pixelsPerLine = ALIGNMENT / sizeof(MNISTPixel);
+	return (IMAGE_SIZE + pixelsPerLine - 1) / pixelsPerLine * pixelsPerLine;
+}
+
+bool MNISTSplit::load(const std::string& imagesPath, const std::string& labelsPath)
+{
+	// Read the whole idx file at once
+	auto buffer = mnist::read_mnist_file(imagesPath, 0x803);
+	if (!buffer) {
+		return false;
+	}
+	size_t count = mnist::read_header(buffer, 1);
+	size_t rows = mnist::read_header(buffer, 2);
+	size_t columns = mnist::read_header(buffer, 3);
+	if (rows * columns != IMAGE_SIZE) {
+		return false;
+	}
+
+	std::vector<uint8_t> readLabels;
+	mnist::read_mnist_label_file<std::vector, uint8_t>(readLabels, labelsPath);
+	if (readLabels.size() != count) {
+		return false;
+	}
+
+	MNISTPixel* newPixels;
+	uint8_t* newLabels;
+	allocate(count, newPixels, newLabels);
+	size_t stride = this->imageStride;
+
+	// Cast to unsigned char is necessary cause signedness of char is
+	// platform-specific
+	const unsigned char* imageBuffer = reinterpret_cast<const unsigned char*>(buffer.get() + 16);
+	for (size_t i = 0; i < count; i++) {
+		std::copy(imageBuffer, imageBuffer + IMAGE_SIZE, newPixels + i * stride);
+		imageBuffer += IMAGE_SIZE;
+	}
+	std::copy(readLabels.begin(), readLabels.end(), newLabels);
+	return true;
+}
+
+void MNISTSplit::allocate(size_t count, MNISTPixel*& newPixels, uint8_t*& newLabels)
+{
+	// Pixels and labels share a single aligned allocation.
+	size_t pixelsSize = count * getAlignedImageStride() * sizeof(MNISTPixel);
+	size_t alignment = ALIGNMENT;
+	void* memory = ::operator new[](pixelsSize + count, std::align_val_t(alignment));
+	std::shared_ptr<void> newStorage(memory, [alignment](void* ptr) { ::operator delete[](ptr, std::align_val_t(alignment)); });
+
+	newPixels = static_cast<MNISTPixel*>(memory);
+	newLabels = static_cast<uint8_t*>(memory) + pixelsSize;
+	std::fill(newPixels, newPixels + count * getAlignedImageStride(), (MNISTPixel)0);
+	assign(newStorage, newPixels, newLabels, count);
+}
+
+MNISTSplit MNISTSplit::makeStratifiedBatch(size_t batchSize, uint64_t seed) const
+{
+	std::mt19937_64 engine(seed);
+
+	// Images of each class
+	std::vector<uint64_t> classImages[10];
+	for (size_t i = 0; i < this->nbImages; i++) {
+		classImages[this->labels[i] % 10].push_back(i);
+	}
+
+	// Number of images per class, the remainder goes to random classes.
+	size_t quotas[10];
+	std::fill(quotas, quotas + 10, batchSize / 10);
+	uint64_t classes[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+	std::shuffle(classes, classes + 10, engine);
+	for (size_t i = 0; i < batchSize % 10; i++) {
+		quotas[classes[i]]++;
+	}
+
+	// Draw without replacement (partial Fisher-Yates), cycle through the
+	// class if the quota exceeds its number of images.
+	std::vector<uint64_t> batchImages;
+	batchImages.reserve(batchSize);
+	for (int c = 0; c < 10; c++) {
+		std::vector<uint64_t>& images = classImages[c];
+		for (size_t i = 0; i < quotas[c] && !images.empty(); i++) {
+			size_t k = i % images.size();
+			if (k == i) {
+				std::uniform_int_distribution<size_t> draw(k, images.size() - 1);
+				std::swap(images[k], images[draw(engine)]);
+			}
+			batchImages.push_back(images[k]);
+		}
+	}
+	std::shuffle(batchImages.begin(), batchImages.end(), engine);
+
+	// Copy the images, and their features, contiguously
+	MNISTSplit batch;
+	MNISTPixel* batchPixels;
+	uint8_t* batchLabels;
+	batch.allocate(batchImages.size(), batchPixels, batchLabels);
+	for (size_t i = 0; i < batchImages.size(); i++) {
+		const MNISTPixel* image = this->getImage(batchImages[i]);
+		std::copy(image, image + this->imageStride, batchPixels + i * batch.imageStride);
+		batchLabels[i] = this->labels[batchImages[i]];
+	}
+	if (this->features != NULL) {
+		batch.features = std::make_shared<const MNISTFeaturePlanes>(*this->features, batchImages);
+	}
+	return batch;
+}
+
+MNISTBatchCache::MNISTBatchCache(const MNISTSplit& source, size_t batchSize, size_t capacity) :
+	source{ source }, batchSize{ batchSize }, capacity{ capacity }, batchOrder(batchSize)
+{
+	std::iota(this->batchOrder.begin(), this->batchOrder.end(), 0);
+}
+
+std::shared_ptr<const MNISTSplit> MNISTBatchCache::getBatch(uint64_t seed)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	auto it = this->batches.find(seed);
+	if (it != this->batches.end()) {
+		return it->second;
+	}
+
+	// Drawn under the lock: the other environments need the same batch.
+	std::shared_ptr<const MNISTSplit> batch = std::make_shared<const MNISTSplit>(this->source.makeStratifiedBatch(this->batchSize, seed));
+	this->batches[seed] = batch;
+	this->insertionOrder.push_back(seed);
+	if (this->insertionOrder.size() > this->capacity) {
+		this->batches.erase(this->insertionOrder.front());
+		this->insertionOrder.pop_front();
+	}
+	return batch;
+}
+
+void MNISTSplit::assign(std::shared_ptr<const void> newStorage, const MNISTPixel* newPixels, const uint8_t* newLabels, size_t newNbImages)
+{
+	this->storage = newStorage;
+	this->pixels = newPixels;
+	this->labels = newLabels;
+	this->nbImages = newNbImages;
+	this->imageStride = getAlignedImageStride();
+	this->features = NULL;
+}
+
+size_t MNISTSplit::getMemorySize() const
+{
+	size_t featuresSize = (this->features != NULL) ? this->features->getMemorySize() : 0;
+	return this->nbImages * this->imageStride * sizeof(MNISTPixel) + this->nbImages + featuresSize;
+}
+
+void MNISTSplit::computeFeatures()
+{
+	this->features = std::make_shared<const MNISTFeaturePlanes>(*this);
+}
+
+std::string MNISTDataset::getCachePath(const std::string& folder)
+{
+	return folder + "/mnist_" + (std::is_floating_point<MNISTPixel>::value ? "f" : "u")
+		+ std::to_string(8 * sizeof(MNISTPixel)) + ".bin";
+}
+
+bool MNISTDataset::mapCache(const std::string& cachePath, const std::string& folder, MNISTCacheHeader& expected)
+{
+	std::shared_ptr<const void> mapping;
+	size_t mappedSize = 0;
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(cachePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx(file, &fileSize);
+	mappedSize = (size_t)fileSize.QuadPart;
+	HANDLE fileMapping = (mappedSize > 0) ? CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+	CloseHandle(file);
+	if (fileMapping == NULL) {
+		return false;
+	}
+	const void* view = MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(fileMapping);
+	if (view == NULL) {
+		return false;
+	}
+	mapping = std::shared_ptr<const void>(view, [](const void* ptr) { UnmapViewOfFile(ptr); });
+#else
+	int fd = open(cachePath.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0) {
+		close(fd);
+		return false;
+	}
+	mappedSize = (size_t)fileStat.st_size;
+	void* view = mmap(NULL, mappedSize, PROT_READ, MAP_SHARED, fd, 0);
+	// The mapping stays valid once the file is closed.
+	close(fd);
+	if (view == MAP_FAILED) {
+		return false;
+	}
+	mapping = std::shared_ptr<const void>(view, [mappedSize](const void* ptr) { munmap(const_cast<void*>(ptr), mappedSize); });
+#endif
+
+	// Check the cache was written from idx files with the same size, with the
+	// same pixel type.
+	if (mappedSize < sizeof(MNISTCacheHeader)) {
+		return false;
+	}
+	const MNISTCacheHeader& header = *static_cast<const MNISTCacheHeader*>(mapping.get());
+	if (memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 || header.version != expected.version ||
+		header.pixelSize != expected.pixelSize || header.pixelIsFloat != expected.pixelIsFloat ||
+		header.imageStride != expected.imageStride || header.fileSize != mappedSize ||
+		memcmp(header.sourceSizes, expected.sourceSizes, sizeof(header.sourceSizes)) != 0) {
+		return false;
+	}
+
+	// Idx files touched since the cache was written are hashed, and the cache
+	// is kept if their content did not change. The new modification times are
+	// then stored, so that following loads do not hash them again.
+	if (memcmp(header.sourceMTimes, expected.sourceMTimes, sizeof(header.sourceMTimes)) != 0) {
+		hashCacheSources(expected, folder);
+		if (memcmp(header.sourceHashes, expected.sourceHashes, sizeof(header.sourceHashes)) != 0) {
+			return false;
+		}
+		std::fstream file(cachePath, std::ios::in | std::ios::out | std::ios::binary);
+		file.seekp(offsetof(MNISTCacheHeader, sourceMTimes));
+		file.write(reinterpret_cast<const char*>(expected.sourceMTimes), sizeof(expected.sourceMTimes));
+	}
+
+	const char* base = static_cast<const char*>(mapping.get());
+	MNISTSplit* splits[2] = { &training, &test };
+	for (int i = 0; i < 2; i++) {
+		uint64_t pixelsEnd = header.pixelsOffset[i] + header.nbImages[i] * header.imageStride * sizeof(MNISTPixel);
+		if (pixelsEnd > mappedSize || header.labelsOffset[i] + header.nbImages[i] > mappedSize) {
+			return false;
+		}
+		splits[i]->assign(mapping, reinterpret_cast<const MNISTPixel*>(base + header.pixelsOffset[i]),
+			reinterpret_cast<const uint8_t*>(base + header.labelsOffset[i]), header.nbImages[i]);
+	}
+	return true;
+}
+
+void MNISTDataset::writeCache(const std::string& cachePath, const std::string& folder, MNISTCacheHeader& header) const
+{
+	// The idx files may already have been hashed by mapCache().
+	hashCacheSources(header, folder);
+
+	const MNISTSplit* splits[2] = { &training, &test };
+	uint64_t offset = alignOffset(sizeof(MNISTCacheHeader));
+	for (int i = 0; i < 2; i++) {
+		header.nbImages[i] = splits[i]->size();
+		header.pixelsOffset[i] = offset;
+		offset = alignOffset(offset + splits[i]->size() * header.imageStride * sizeof(MNISTPixel));
+		header.labelsOffset[i] = offset;
+		offset = alignOffset(offset + splits[i]->size());
+	}
+	header.fileSize = offset;
+
+	// Write in a temporary file first, so that concurrent processes never map
+	// a partially written cache.
+	std::string tmpPath = cachePath + ".tmp" + std::to_string(getpid());
+	std::ofstream file(tmpPath, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file) {
+		std::cerr << "Could not write the MNIST cache " << cachePath << std::endl;
+		return;
+	}
+	auto writeAt = [&file](uint64_t position, const void* data, size_t size) {
+		std::vector<char> padding(position - (uint64_t)file.tellp(), 0);
+		file.write(padding.data(), padding.size());
+		file.write(static_cast<const char*>(data), size);
+	};
+	writeAt(0, &header, sizeof(header));
+	for (int i = 0; i < 2; i++) {
+		writeAt(header.pixelsOffset[i], splits[i]->getImage(0), splits[i]->size() * header.imageStride * sizeof(MNISTPixel));
+		writeAt(header.labelsOffset[i], splits[i]->getLabels(), splits[i]->size());
+	}
+	writeAt(header.fileSize, NULL, 0);
+	file.close();
+
+	if (!file || std::rename(tmpPath.c_str(), cachePath.c_str()) != 0) {
+		std::remove(tmpPath.c_str());
+		std::cerr << "Could not write the MNIST cache " << cachePath << std::endl;
+	}
+}
+
+MNISTDataset::MNISTDataset(const std::string& folder, bool withFeatures) : MNISTDataset(folder)
+{
+	if (withFeatures) {
+		training.computeFeatures();
+		test.computeFeatures();
+	}
+}
+
+MNISTDataset::MNISTDataset(const std::string& folder)
+{
+	std::string cachePath = getCachePath(folder);
+	MNISTCacheHeader header;
+	initCacheHeader(header, folder);
+	if (mapCache(cachePath, folder, header)) {
+		std::cout << "MNIST dataset mapped from " << cachePath << std::endl;
+		return;
+	}
+
+	if (!training.load(folder + IDX_FILES[0], folder + IDX_FILES[1]) ||
+		!test.load(folder + IDX_FILES[2], folder + IDX_FILES[3])) {
+		throw std::runtime_error("Initialization of MNIST databased failed.");
+	}
+	writeCache(cachePath, folder, header);
+}
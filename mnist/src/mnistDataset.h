@@ -0,0 +1,248 @@
+#ifndef MNIST_DATASET_H
+#define MNIST_DATASET_H
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifndef MNIST_PIXEL_TYPE
+#define MNIST_PIXEL_TYPE uint8_t
+#endif
+
+/// Type of the pixels stored in the dataset (uint8_t or float).
+typedef MNIST_PIXEL_TYPE MNISTPixel;
+
+class MNISTFeaturePlanes;
+struct MNISTCacheHeader;
+
+/**
+* \brief Images and labels of one split (training or test) of the MNIST
+* database.
+*
+* All the images of the split are stored in a single buffer, one after the
+* other. Each image starts on a cache line. The buffer is either allocated
+* when parsing the idx files, or mapped from a binary cache file.
+*/
+class MNISTSplit {
+protected:
+	/// Memory holding the pixels and the labels.
+	std::shared_ptr<const void> storage;
+
+	/// Pixels of all the images.
+	const MNISTPixel* pixels = NULL;
+
+	/// Label of each image.
+	const uint8_t* labels = NULL;
+
+	/// Number of images in the split.
+	size_t nbImages = 0;
+
+	/// Number of pixels between the start of two consecutive images.
+	size_t imageStride = 0;
+
+	/// Feature planes of the images, NULL if they were not computed.
+	std::shared_ptr<const MNISTFeaturePlanes> features;
+
+	/**
+	* \brief Allocate an aligned buffer for nbImages images and their labels,
+	* and use it as storage of the split.
+	*
+	* \param[out] newPixels pixels of the allocated images, set to 0.
+	* \param[out] newLabels labels of the allocated images.
+	*/
+	void allocate(size_t nbImages, MNISTPixel*& newPixels, uint8_t*& newLabels);
+
+public:
+	/// Width of the images.
+	static const size_t IMAGE_WIDTH = 28;
+
+	/// Height of the images.
+	static const size_t IMAGE_HEIGHT = 28;
+
+	/// Number of pixels of an image.
+	static const size_t IMAGE_SIZE = IMAGE_WIDTH * IMAGE_HEIGHT;
+
+	/// Alignment of the images in the buffer, in bytes.
+	static const size_t ALIGNMENT = 64;
+
+	/// Number of pixels between two images, so that they all start on a
+	/// cache line.
+	static size_t getAlignedImageStride();
+
+	/**
+	* \brief Load the split from the idx files of the MNIST database.
+	*
+	* \param[in] imagesPath path to the idx3 file of the images.
+	* \param[in] labelsPath path to the idx1 file of the labels.
+	* \return false if a file could not be read.
+	*/
+	bool load(const std::string& imagesPath, const std::string& labelsPath);
+
+	/**
+	* \brief Use images and labels stored in memory owned by someone else.
+	*
+	* \param[in] storage keeps the memory of pixels and labels alive.
+	* \param[in] pixels nbImages images, getAlignedImageStride() pixels apart.
+	* \param[in] labels nbImages labels.
+	* \param[in] nbImages number of images in the split.
+	*/
+	void assign(std::shared_ptr<const void> storage, const MNISTPixel* pixels, const uint8_t* labels, size_t nbImages);
+
+	/// Get the number of images of the split.
+	size_t size() const { return nbImages; }
+
+	/// Get the IMAGE_SIZE pixels of an image, row by row.
+	const MNISTPixel* getImage(size_t index) const { return pixels + index * imageStride; }
+
+	/// Get the label of an image.
+	uint8_t getLabel(size_t index) const { return labels[index]; }
+
+	/// Get the labels of all the images.
+	const uint8_t* getLabels() const { return labels; }
+
+	/// Get the number of bytes used to store the split and its features.
+	size_t getMemorySize() const;
+
+	/// Compute the feature planes of all the images of the split.
+	void computeFeatures();
+
+	/// Get the feature planes of the images, or NULL if not computed.
+	const MNISTFeaturePlanes* getFeatures() const { return features.get(); }
+
+	/**
+	* \brief Draw a class-stratified batch of images from the split.
+	*
+	* Each of the 10 classes gets batchSize / 10 images (the remainder goes
+	* to randomly chosen classes), drawn without replacement while the class
+	* has enough images. The images are presented in random order, and are
+	* copied contiguously in the storage of the returned split, along with
+	* their feature planes if the split has some.
+	*
+	* \param[in] batchSize number of images of the batch.
+	* \param[in] seed seed of the random draws.
+	*/
+	MNISTSplit makeStratifiedBatch(size_t batchSize, uint64_t seed) const;
+};
+
+/**
+* \brief Stratified batches of a split, shared by all the LearningEnvironments.
+*
+* The LearningAgent resets all the roots of a generation with the same seeds,
+* so each batch is drawn once and then reused by every evaluation with the
+* same seed. Only the most recent batches are kept.
+*/
+class MNISTBatchCache {
+protected:
+	/// Split the batches are drawn from.
+	const MNISTSplit& source;
+
+	/// Number of images of each batch.
+	size_t batchSize;
+
+	/// Maximum number of batches kept.
+	size_t capacity;
+
+	/// Cached batches, indexed by seed.
+	std::map<uint64_t, std::shared_ptr<const MNISTSplit>> batches;
+
+	/// Seeds of the cached batches, from the oldest to the newest.
+	std::deque<uint64_t> insertionOrder;
+
+	/// Order presenting the images of a batch one after the other.
+	std::vector<uint64_t> batchOrder;
+
+	/// Environments are reset from several threads.
+	std::mutex mutex;
+
+public:
+	/**
+	* \brief Constructor.
+	*
+	* \param[in] source split the batches are drawn from.
+	* \param[in] batchSize number of images of each batch.
+	* \param[in] capacity maximum number of batches kept.
+	*/
+	MNISTBatchCache(const MNISTSplit& source, size_t batchSize, size_t capacity = 16);
+
+	/// Get the batch for a seed, drawing it on the first request.
+	std::shared_ptr<const MNISTSplit> getBatch(uint64_t seed);
+
+	/// Get the order presenting the images of a batch one after the other.
+	const std::vector<uint64_t>& getBatchOrder() const { return batchOrder; }
+
+	/// Get the number of images of each batch.
+	size_t getBatchSize() const { return batchSize; }
+};
+
+/**
+* \brief MNIST database, with its training and test splits.
+*
+* The first time the database is loaded from a folder, the parsed images are
+* written in a binary cache file next to the idx files. Following loads map
+* this file in memory, read-only, so that all the processes training on a
+* node share the same physical pages.
+*/
+class MNISTDataset {
+protected:
+	/**
+	* \brief Map the binary cache file in memory.
+	*
+	* The size and the modification time of the idx files are compared to
+	* those stored in the cache when it was written. Only when a modification
+	* time differs is the content of the idx files hashed, and compared to the
+	* hashes stored in the cache.
+	*
+	* \param[in] cachePath path of the cache file.
+	* \param[in] folder folder of the idx files.
+	* \param[in,out] expected header expected for the current idx files,
+	* whose hashes are filled if computed.
+	* \return false if the file is missing, or was not written from the
+	* current idx files with the current MNISTPixel type.
+	*/
+	bool mapCache(const std::string& cachePath, const std::string& folder, MNISTCacheHeader& expected);
+
+	/**
+	* \brief Write the splits in a binary cache file.
+	*
+	* \param[in] cachePath path of the cache file.
+	* \param[in] folder folder of the idx files.
+	* \param[in,out] header header expected for the current idx files, whose
+	* hashes are filled if not computed yet.
+	*/
+	void writeCache(const std::string& cachePath, const std::string& folder, MNISTCacheHeader& header) const;
+
+public:
+	/// Images used in TRAINING and VALIDATION modes.
+	MNISTSplit training;
+
+	/// Images used in TESTING mode.
+	MNISTSplit test;
+
+	/**
+	* \brief Load the database from the idx files of a folder, or from its
+	* binary cache.
+	*
+	* \param[in] folder the folder containing the uncompressed idx files.
+	* \throw std::runtime_error if a file could not be read.
+	*/
+	MNISTDataset(const std::string& folder);
+
+	/**
+	* \brief Load the database from the idx files of a folder, or from its
+	* binary cache, and compute the feature planes of the images.
+	*
+	* \param[in] folder the folder containing the uncompressed idx files.
+	* \param[in] withFeatures whether the feature planes are computed.
+	* \throw std::runtime_error if a file could not be read.
+	*/
+	MNISTDataset(const std::string& folder, bool withFeatures);
+
+	/// Get the path of the binary cache file for a folder.
+	static std::string getCachePath(const std::string& folder);
+};
+
+#endif
@@ -0,0 +1,73 @@
+#include <algorithm>
+#include <cmath>
+#include <new>
+
+#include "mnistFeatures.h"
+
+void MNISTFeaturePlanes::allocate()
+{
+	size_t nbValues = this->nbImages * NB_PLANES * PLANE_STRIDE;
+	size_t alignment = MNISTSplit::ALIGNMENT;
+	void* memory = ::operator new[](nbValues * sizeof(float), std::align_val_t(alignment));
+	this->planes = std::shared_ptr<float>(static_cast<float*>(memory), [alignment](float* ptr) { ::operator delete[](ptr, std::align_val_t(alignment)); });
+	std::fill(this->planes.get(), this->planes.get() + nbValues, 0.0f);
+}
+
+MNISTFeaturePlanes::MNISTFeaturePlanes(const MNISTSplit& split) :
+	nbImages(split.size())
+{
+	allocate();
+	for (size_t i = 0; i < this->nbImages; i++) {
+		float* magnitude = this->planes.get() + (i * NB_PLANES + SOBEL_MAGNITUDE) * PLANE_STRIDE;
+		float* direction = this->planes.get() + (i * NB_PLANES + SOBEL_DIRECTION) * PLANE_STRIDE;
+		computeSobel(split.getImage(i), magnitude, direction);
+	}
+}
+
+MNISTFeaturePlanes::MNISTFeaturePlanes(const MNISTFeaturePlanes& source, const std::vector<uint64_t>& indices) :
+	nbImages(indices.size())
+{
+	allocate();
+	for (size_t i = 0; i < this->nbImages; i++) {
+		const float* sourcePlanes = source.getPlane(indices[i], SOBEL_MAGNITUDE);
+		std::copy(sourcePlanes, sourcePlanes + NB_PLANES * PLANE_STRIDE, this->planes.get() + i * NB_PLANES * PLANE_STRIDE);
+	}
+}
+
+void MNISTFeaturePlanes::computeSobel(const MNISTPixel* image, float* magnitude, float* direction)
+{
+	const size_t width = MNISTSplit::IMAGE_WIDTH;
+
+	// Convert the image once, the convolution then runs on floats only.
+	float pixels[MNISTSplit::IMAGE_SIZE];
+	std::copy(image, image + MNISTSplit::IMAGE_SIZE, pixels);
+
+	for (size_t y = 0; y < PLANE_HEIGHT; y++) {
+		const float* a0 = pixels + y * width;
+		const float* a1 = a0 + width;
+		const float* a2 = a1 + width;
+		float gx[PLANE_WIDTH];
+		float gy[PLANE_WIDTH];
+
+		// Independent iterations on contiguous rows: vectorized loops.
+		for (size_t x = 0; x < PLANE_WIDTH; x++) {
+			gx[x] = -a0[x] + a0[x + 2]
+				- 2.0f * a1[x] + 2.0f * a1[x + 2]
+				- a2[x] + a2[x + 2];
+			gy[x] = -a0[x] - 2.0f * a0[x + 1] - a0[x + 2]
+				+ a2[x] + 2.0f * a2[x + 1] + a2[x + 2];
+		}
+		// Vectorized with -fno-math-errno only.
+		float* magnitudeRow = magnitude + y * PLANE_WIDTH;
+		for (size_t x = 0; x < PLANE_WIDTH; x++) {
+			magnitudeRow[x] = std::sqrt(gx[x] * gx[x] + gy[x] * gy[x]);
+		}
+
+		// Same value as the sobelDir instruction, including the NaN of flat
+		// windows.
+		float* directionRow = direction + y * PLANE_WIDTH;
+		for (size_t x = 0; x < PLANE_WIDTH; x++) {
+			directionRow[x] = std::atan(gy[x] / gx[x]);
+		}
+	}
+}
@@ -0,0 +1,87 @@
+#ifndef MNIST_FEATURES_H
+#define MNIST_FEATURES_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "mnistDataset.h"
+
+/**
+* \brief Feature planes precomputed for each image of a split.
+*
+* Each 3x3 window of an image gives one value of each plane: the magnitude
+* and the direction of its Sobel gradient, as computed by the sobelMagn and
+* sobelDir instructions. The value at (x, y) of a plane corresponds to the
+* window whose top-left pixel is at (x, y) in the image.
+*
+* Planes are computed once for all the images, so that programs read them as
+* plain operands instead of computing a 3x3 convolution on each execution.
+*/
+class MNISTFeaturePlanes {
+public:
+	/// Planes available for each image.
+	enum Plane {
+		SOBEL_MAGNITUDE = 0,
+		SOBEL_DIRECTION = 1,
+		NB_PLANES
+	};
+
+	/// Width of the planes.
+	static const size_t PLANE_WIDTH = MNISTSplit::IMAGE_WIDTH - 2;
+
+	/// Height of the planes.
+	static const size_t PLANE_HEIGHT = MNISTSplit::IMAGE_HEIGHT - 2;
+
+	/// Number of values of a plane.
+	static const size_t PLANE_SIZE = PLANE_WIDTH * PLANE_HEIGHT;
+
+	/// Number of values between the start of two planes, so that all the
+	/// planes start on a MNISTSplit::ALIGNMENT boundary.
+	static const size_t PLANE_STRIDE = (PLANE_SIZE + 15) / 16 * 16;
+
+protected:
+	/// Planes of all the images, image by image, aligned on
+	/// MNISTSplit::ALIGNMENT bytes.
+	std::shared_ptr<float> planes;
+
+	/// Number of images.
+	size_t nbImages;
+
+	/// Allocate the zeroed planes of nbImages images.
+	void allocate();
+
+public:
+	/// Compute the planes of all the images of a split.
+	MNISTFeaturePlanes(const MNISTSplit& split);
+
+	/**
+	* \brief Copy the planes of some images.
+	*
+	* \param[in] source the planes to copy.
+	* \param[in] indices the images to copy, in the order of the copy.
+	*/
+	MNISTFeaturePlanes(const MNISTFeaturePlanes& source, const std::vector<uint64_t>& indices);
+
+	/// Get the PLANE_SIZE values of a plane of an image, row by row.
+	const float* getPlane(size_t index, Plane plane) const { return planes.get() + (index * NB_PLANES + plane) * PLANE_STRIDE; }
+
+	/// Get the number of bytes used to store the planes.
+	size_t getMemorySize() const { return nbImages * NB_PLANES * PLANE_STRIDE * sizeof(float); }
+
+	/**
+	* \brief Compute the Sobel planes of an image.
+	*
+	* Rows are processed a whole plane row at once, so that the compiler
+	* vectorizes the convolution and the magnitude. The magnitude loop is
+	* only vectorized because the file is compiled with -fno-math-errno,
+	* std::sqrt otherwise calls the library for negative inputs.
+	*
+	* \param[in] image the IMAGE_SIZE pixels of the image.
+	* \param[out] magnitude the PLANE_SIZE values of the magnitude plane.
+	* \param[out] direction the PLANE_SIZE values of the direction plane.
+	*/
+	static void computeSobel(const MNISTPixel* image, float* magnitude, float* direction);
+};
+
+#endif
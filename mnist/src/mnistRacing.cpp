@@ -0,0 +1,46 @@
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+#include "mnistRacing.h"
+
+MNISTRace::MNISTRace(uint64_t minNbSamples, uint64_t nbSamplesPerEval, double ratioDeletedRoots) :
+	minNbSamples{ minNbSamples }, nbSamplesPerEval{ nbSamplesPerEval }, ratioDeletedRoots{ ratioDeletedRoots }
+{
+}
+
+double MNISTRace::getCutoff(uint64_t generationNumber)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	if (generationNumber != this->currentGeneration) {
+		// Quantile of the accuracies of all the evaluations of the previous
+		// generation, see the class documentation.
+		this->cutoff = 0.0;
+		if (!this->accuracies.empty() && generationNumber == this->currentGeneration + 1) {
+			std::sort(this->accuracies.begin(), this->accuracies.end(), std::greater<double>());
+			size_t nbSurvivors = (size_t)std::ceil((1.0 - this->ratioDeletedRoots) * this->accuracies.size());
+			this->cutoff = this->accuracies.at(std::min(std::max<size_t>(nbSurvivors, 1), this->accuracies.size()) - 1);
+		}
+		this->accuracies.clear();
+		this->currentGeneration = generationNumber;
+	}
+	return this->cutoff;
+}
+
+void MNISTRace::addAccuracy(uint64_t generationNumber, double accuracy)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	if (generationNumber == this->currentGeneration) {
+		this->accuracies.push_back(accuracy);
+	}
+}
+
+bool MNISTRace::isLost(uint64_t nbCorrect, uint64_t nbSamples, double cutoff) const
+{
+	if (nbSamples < this->minNbSamples || nbSamples >= this->nbSamplesPerEval) {
+		return false;
+	}
+	// Optimistic bound: all the remaining samples are correctly classified.
+	uint64_t bestNbCorrect = nbCorrect + (this->nbSamplesPerEval - nbSamples);
+	return (double)bestNbCorrect < cutoff * (double)this->nbSamplesPerEval;
+}
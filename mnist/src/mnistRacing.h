@@ -0,0 +1,95 @@
+#ifndef MNIST_RACING_H
+#define MNIST_RACING_H
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+* \brief Race between the roots evaluated in TRAINING mode.
+*
+* An evaluation is lost when, after a minimum number of samples, classifying
+* correctly all its remaining samples would not reach the survival cutoff of
+* the generation. Its remaining samples are then counted as misclassified, so
+* it still ends with all its samples and a pessimistic accuracy.
+*
+* The accuracy of each TRAINING evaluation is recorded, lost ones included.
+* Roots kept from earlier generations are evaluated again, and raced, at each
+* generation, as long as they have not reached maxNbEvaluationPerPolicy. At
+* the beginning of a generation, the survival cutoff is the
+* (1 - ratioDeletedRoots) quantile, from the highest, of the accuracies of
+* all the roots evaluated in the previous generation: new roots and
+* re-evaluated survivors, lost or not.
+*
+* The LearningAgent combines the results of all the evaluations of a root.
+* A lost re-evaluation of a survivor thus folds its synthetic
+* misclassifications into the combined score of the survivor, which may then
+* be deleted even though its earlier evaluations were complete.
+*
+* The cutoff is an accuracy, while the LearningAgent ranks roots with the
+* score of the ClassificationLearningEnvironment. It is thus a heuristic, not
+* the score of the last survivor of the previous generation.
+*
+* Shared by all the clones of a LearningEnvironment.
+*/
+class MNISTRace {
+protected:
+	/// Number of samples classified before an evaluation can be lost.
+	uint64_t minNbSamples;
+
+	/// Number of samples of a complete evaluation.
+	uint64_t nbSamplesPerEval;
+
+	/// Ratio of roots deleted at each generation.
+	double ratioDeletedRoots;
+
+	/// Generation of the recorded accuracies.
+	uint64_t currentGeneration = 0;
+
+	/// Accuracies of the complete evaluations of the current generation.
+	std::vector<double> accuracies;
+
+	/// Survival cutoff of the current generation, 0 while unknown.
+	double cutoff = 0.0;
+
+	/// Environments are evaluated from several threads.
+	std::mutex mutex;
+
+public:
+	/**
+	* \brief Constructor.
+	*
+	* \param[in] minNbSamples number of samples classified before an
+	* evaluation can be lost.
+	* \param[in] nbSamplesPerEval number of samples of a complete evaluation.
+	* \param[in] ratioDeletedRoots ratio of roots deleted at each generation.
+	*/
+	MNISTRace(uint64_t minNbSamples, uint64_t nbSamplesPerEval, double ratioDeletedRoots);
+
+	/**
+	* \brief Get the survival cutoff of a generation.
+	*
+	* The first call for a new generation computes the cutoff from the
+	* accuracies recorded in the previous one. The cutoff is 0 if the
+	* previous generation recorded no accuracy.
+	*/
+	double getCutoff(uint64_t generationNumber);
+
+	/// Record the accuracy of an evaluation of a generation.
+	void addAccuracy(uint64_t generationNumber, double accuracy);
+
+	/// Get the number of samples of a complete evaluation.
+	uint64_t getNbSamplesPerEval() const { return nbSamplesPerEval; }
+
+	/**
+	* \brief Check whether an evaluation can still reach the cutoff.
+	*
+	* \param[in] nbCorrect number of samples correctly classified so far.
+	* \param[in] nbSamples number of samples classified so far.
+	* \param[in] cutoff the survival cutoff of the generation.
+	* \return true if the evaluation is lost.
+	*/
+	bool isLost(uint64_t nbCorrect, uint64_t nbSamples, double cutoff) const;
+};
+
+#endif
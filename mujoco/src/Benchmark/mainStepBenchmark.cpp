@@ -0,0 +1,217 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <cstring>
+#include <getopt.h>
+
+#include "../mujocoAntWrapper.h"
+#include "../mujocoTaskRegistry.h"
+
+/**
+* \brief Ant with the step implementation preceding MujocoAntWrapper::step().
+*
+* Baseline of the benchmark: the actions are taken by value, copied one by
+* one in the controls, the clamped contact forces are stored in a vector
+* allocated at each step, and the observation is written element by element
+* with setDataAt(). The rewards are the same as those of step().
+*/
+class LegacyStepAntWrapper : public MujocoAntWrapper
+{
+public:
+	LegacyStepAntWrapper(std::string actFunc, const char* pXmlFile) :
+		MujocoAntWrapper(actFunc, pXmlFile) {};
+
+	/// Step the ant as doActions() did before step() was introduced.
+	void legacyStep(std::vector<double> actionsID)
+	{
+		auto x_pos_before = d_->qpos[0];
+		for (int i = 0; i < m_->nu; i++) {
+			d_->ctrl[i] = actionsID[i];
+		}
+		for (int i = 0; i < frame_skip_; i++) {
+			mj_step(m_, d_);
+		}
+		post_constraint_valid_ = false;
+		auto x_pos_after = d_->qpos[0];
+		auto x_vel = (x_pos_after - x_pos_before) / dt();
+		auto rewards = x_vel + healthy_reward();
+
+		double ctrl_cost = 0;
+		for (auto& a : actionsID) ctrl_cost += a * a;
+		auto costs = control_cost_weight_ * ctrl_cost;
+		if (use_contact_forces_) {
+			ensure_post_constraint();
+			std::vector<double> forces;
+			std::copy_n(d_->cfrc_ext, m_->nbody * 6, back_inserter(forces));
+			for (auto& f : forces) {
+				f = std::max(contact_force_range_[0],
+								std::min(f, contact_force_range_[1]));
+			}
+			double contact_cost = 0;
+			for (auto& f : forces) contact_cost += f * f;
+			costs += contact_cost_weight_ * contact_cost;
+		}
+
+		int index = 0;
+		for (int i = 0; i < m_->nq; i++) {
+			currentState.setDataAt(typeid(double), index, d_->qpos[i]);
+			index++;
+		}
+		for (int i = 0; i < m_->nv; i++) {
+			currentState.setDataAt(typeid(double), index, d_->qvel[i]);
+			index++;
+		}
+
+		this->totalReward += rewards - costs;
+		this->nbActionsExecuted++;
+	}
+};
+
+/**
+* \brief Run nbSteps steps of the environment and return the number of steps
+* per second.
+*
+* \param[in] le the environment to step.
+* \param[in] actions the sequence of actions applied, cycled over.
+* \param[in] nbSteps number of steps to execute.
+* \param[in] step function stepping le with an action.
+*/
+template <class Step>
+double runSteps(MujocoWrapper& le, const std::vector<std::vector<double>>& actions, uint64_t nbSteps, Step step)
+{
+	le.reset(0);
+
+	auto start = std::chrono::steady_clock::now();
+	for (uint64_t i = 0; i < nbSteps; i++) {
+		step(actions[i % actions.size()]);
+		if (le.isTerminal()) {
+			le.reset(i);
+		}
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	return nbSteps / std::chrono::duration<double>(end - start).count();
+}
+
+/**
+* \brief Reset the environment nbResets times, cycling over nbSeeds seeds,
+* and return the number of resets per second.
+*
+* \param[in] le the environment to reset.
+* \param[in] nbResets number of resets to execute.
+* \param[in] nbSeeds number of distinct seeds.
+* \param[in] useCache if false, the cache of initial states is cleared
+* before each reset, so that the initial state is always recomputed.
+*/
+double runResets(MujocoWrapper& le, uint64_t nbResets, uint64_t nbSeeds, bool useCache)
+{
+	le.state_cache_->clear();
+
+	auto start = std::chrono::steady_clock::now();
+	for (uint64_t i = 0; i < nbResets; i++) {
+		if (!useCache) {
+			le.state_cache_->clear();
+		}
+		le.reset(i % nbSeeds);
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	return nbResets / std::chrono::duration<double>(end - start).count();
+}
+
+int main(int argc, char** argv) {
+
+	char option;
+	uint64_t nbSteps = 100000;
+	char xmlFile[150];
+	char taskName[150];
+	bool useContactForces = false;
+	int frameSkip = 1;
+	strcpy(xmlFile, "");
+	strcpy(taskName, "ant");
+	while ((option = getopt(argc, argv, "n:x:ck:t:")) != -1) {
+		switch (option) {
+			case 'n': nbSteps = atoll(optarg); break;
+			case 'x': strcpy(xmlFile, optarg); break;
+			case 'c': useContactForces = true; break;
+			case 'k': frameSkip = atoi(optarg); break;
+			case 't': strcpy(taskName, optarg); break;
+			default: std::cout << "Unrecognised option. Valid options are \'-n nbSteps\' \'-x xmlFile\' \'-c\' (use ant contact forces) \'-k frameSkip\' \'-t task\'." << std::endl; exit(1);
+		}
+	}
+
+	const MujocoTask* task = findMujocoTask(taskName);
+	if (task == NULL) {
+		std::cout << "Unknown task " << taskName << "." << std::endl;
+		exit(1);
+	}
+	if (strlen(xmlFile) == 0) {
+		strcpy(xmlFile, task->defaultXmlFile.c_str());
+	}
+
+	std::unique_ptr<MujocoWrapper> mujocoLEPtr(task->create("none", xmlFile));
+	MujocoWrapper& mujocoLE = *mujocoLEPtr;
+	mujocoLE.frame_skip_ = frameSkip;
+	MujocoAntWrapper* mujocoAntLE = dynamic_cast<MujocoAntWrapper*>(&mujocoLE);
+	if (mujocoAntLE != NULL) {
+		mujocoAntLE->use_contact_forces_ = useContactForces;
+	}
+
+	// Pregenerate the actions so that their generation is not measured.
+	Mutator::RNG rng(0);
+	std::vector<std::vector<double>> actions(1000, std::vector<double>(mujocoLE.m_->nu));
+	for (auto& action : actions) {
+		for (auto& a : action) {
+			a = rng.getDouble(-1.0, 1.0);
+		}
+	}
+
+	// doActions() is called through the LearningEnvironment interface, as the
+	// LearningAgent does.
+	Learn::LearningEnvironment& genericLE = mujocoLE;
+	auto vectorStep = [&genericLE](const std::vector<double>& action) {
+		genericLE.doActions(action);
+	};
+	auto viewStep = [&mujocoLE](const std::vector<double>& action) {
+		mujocoLE.step(ActionView(action.data(), action.size()));
+	};
+
+	// Warm up caches and the allocator.
+	runSteps(mujocoLE, actions, nbSteps / 10, vectorStep);
+
+	double vectorSteps = runSteps(mujocoLE, actions, nbSteps, vectorStep);
+	double viewSteps = runSteps(mujocoLE, actions, nbSteps, viewStep);
+
+	std::cout << "Task: " << task->name << " (" << mujocoLE.m_->nu << " actions, " << mujocoLE.obs_size_ << " observations)" << std::endl;
+	std::cout << "Steps: " << nbSteps << ", frame skip: " << frameSkip << (useContactForces ? " (with contact forces)" : "") << std::endl;
+
+	// Baseline of the ant, with the same parameters.
+	if (mujocoAntLE != NULL) {
+		LegacyStepAntWrapper legacyLE("none", xmlFile);
+		legacyLE.frame_skip_ = frameSkip;
+		legacyLE.use_contact_forces_ = useContactForces;
+		auto legacyStep = [&legacyLE](const std::vector<double>& action) {
+			legacyLE.legacyStep(action);
+		};
+		runSteps(legacyLE, actions, nbSteps / 10, legacyStep);
+		double legacySteps = runSteps(legacyLE, actions, nbSteps, legacyStep);
+		std::cout << "Former doActions() (baseline):  " << legacySteps << " steps/s" << std::endl;
+		std::cout << "doActions(std::vector<double>): " << vectorSteps << " steps/s (speedup " << vectorSteps / legacySteps << ")" << std::endl;
+		std::cout << "step(ActionView):               " << viewSteps << " steps/s (speedup " << viewSteps / legacySteps << ")" << std::endl;
+	}
+	else {
+		std::cout << "doActions(std::vector<double>): " << vectorSteps << " steps/s" << std::endl;
+		std::cout << "step(ActionView):               " << viewSteps << " steps/s" << std::endl;
+		std::cout << "Speedup: " << viewSteps / vectorSteps << std::endl;
+	}
+
+	// Seeds are shared by all the roots of a generation, reuse a few of them.
+	double coldResets = runResets(mujocoLE, nbSteps / 10, 10, false);
+	double cachedResets = runResets(mujocoLE, nbSteps / 10, 10, true);
+	std::cout << "reset() without state cache:    " << coldResets << " resets/s" << std::endl;
+	std::cout << "reset() with state cache:       " << cachedResets << " resets/s" << std::endl;
+	std::cout << "Speedup: " << cachedResets / coldResets << std::endl;
+
+	return 0;
+}
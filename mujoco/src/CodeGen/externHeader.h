@@ -0,0 +1,6 @@
+#ifndef EXTERNHEADER
+#define EXTERNHEADER
+#include <float.h>
+#define _USE_MATH_DEFINES
+#include <math.h>
+#endif
\ No newline at end of file
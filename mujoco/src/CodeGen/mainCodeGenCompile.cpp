@@ -0,0 +1,81 @@
+#include <iostream>
+#include <cstring>
+#include <inttypes.h>
+#include <getopt.h>
+
+#include <gegelati.h>
+
+#include "../mujocoTaskRegistry.h"
+#include "../instructions.h"
+#include "continuousTPGGenerationEngine.h"
+
+int main(int argc, char** argv) {
+
+	char option;
+	char paramFile[150];
+	char dotPath[150];
+	char xmlFile[150];
+	char taskName[150];
+	char activation[150];
+	strcpy(paramFile, ROOT_DIR "/params/params_0.json");
+	strcpy(dotPath, "");
+	strcpy(xmlFile, "");
+	strcpy(taskName, "ant");
+	strcpy(activation, "none");
+	while ((option = getopt(argc, argv, "p:d:x:t:a:")) != -1) {
+		switch (option) {
+		case 'p': strcpy(paramFile, optarg); break;
+		case 'd': strcpy(dotPath, optarg); break;
+		case 'x': strcpy(xmlFile, optarg); break;
+		case 't': strcpy(taskName, optarg); break;
+		case 'a': strcpy(activation, optarg); break;
+		default: std::cout << "Unrecognised option. Valid options are \'-p paramFile.json\' \'-d dot path\' \'-x xmlFile\' \'-t task\' \'-a activation\'." << std::endl; exit(1);
+		}
+	}
+	const MujocoTask* task = findMujocoTask(taskName);
+	if (task == NULL) {
+		std::cout << "Unknown task " << taskName << "." << std::endl;
+		exit(1);
+	}
+	if (strlen(xmlFile) == 0) {
+		strcpy(xmlFile, task->defaultXmlFile.c_str());
+	}
+	if (strlen(dotPath) == 0) {
+		std::cout << "No dot file given, use \'-d dot path\'." << std::endl;
+		exit(1);
+	}
+
+	std::cout << "Generate C code from pre-trained dot file " << dotPath << "." << std::endl;
+
+	// Create the instruction set for programs
+	Instructions::Set set;
+	fillInstructionSet(set);
+
+	Learn::LearningParameters params;
+	File::ParametersParser::loadParametersFromJson(paramFile, params);
+	if (params.useMemoryRegisters) {
+		// Registers kept between executions are not part of the generated code.
+		std::cout << "TPGs using memory registers can not be compiled." << std::endl;
+		exit(1);
+	}
+
+	// Instantiate the LearningEnvironment
+	std::unique_ptr<MujocoWrapper> mujocoLEPtr(task->create(activation, xmlFile));
+	MujocoWrapper& mujocoLE = *mujocoLEPtr;
+
+	Environment dotEnv(set, mujocoLE.getDataSources(), params.nbRegisters, params.nbProgramConstant, params.useMemoryRegisters);
+	TPG::TPGGraph dotGraph(dotEnv);
+	File::TPGGraphDotImporter dot(dotPath, dotEnv, dotGraph);
+	dot.importGraph();
+	if (dotGraph.getNbRootVertices() != 1) {
+		std::cout << "The dot file must contain a single root, select the best one with the renderMujoco target." << std::endl;
+		exit(1);
+	}
+
+	// Discrete inference of GEGELATI, and continuous inference from the bids
+	// of its programs
+	ContinuousTPGGenerationEngine tpggen("mujocoTPG", dotGraph, "src/");
+	tpggen.generateContinuousTPG(mujocoLE.getInitActions(), mujocoLE.getActivationFunction());
+
+	return 0;
+}
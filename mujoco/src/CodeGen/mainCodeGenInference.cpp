@@ -0,0 +1,93 @@
+#include <iostream>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <vector>
+#include <inttypes.h>
+#include <getopt.h>
+
+extern "C" {
+#include "externHeader.h"
+#include "mujocoTPG.h"
+#include "mujocoTPG_continuous.h"
+	/// instantiate global variable used to communicate between the TPG and the environment
+	double* in1;
+}
+
+#include "../mujocoTaskRegistry.h"
+#include "../mujocoParameters.h"
+
+int main(int argc, char** argv) {
+
+	char option;
+	uint64_t nbEpisodes = 10;
+	char paramFile[150];
+	char xmlFile[150];
+	char taskName[150];
+	char activation[150];
+	strcpy(paramFile, ROOT_DIR "/params/params_0.json");
+	strcpy(xmlFile, "");
+	strcpy(taskName, "ant");
+	strcpy(activation, "none");
+	while ((option = getopt(argc, argv, "n:p:x:t:a:")) != -1) {
+		switch (option) {
+		case 'n': nbEpisodes = atoll(optarg); break;
+		case 'p': strcpy(paramFile, optarg); break;
+		case 'x': strcpy(xmlFile, optarg); break;
+		case 't': strcpy(taskName, optarg); break;
+		case 'a': strcpy(activation, optarg); break;
+		default: std::cout << "Unrecognised option. Valid options are \'-n nbEpisodes\' \'-p paramFile.json\' \'-x xmlFile\' \'-t task\' \'-a activation\'." << std::endl; exit(1);
+		}
+	}
+	const MujocoTask* task = findMujocoTask(taskName);
+	if (task == NULL) {
+		std::cout << "Unknown task " << taskName << "." << std::endl;
+		exit(1);
+	}
+	if (strlen(xmlFile) == 0) {
+		strcpy(xmlFile, task->defaultXmlFile.c_str());
+	}
+
+	Learn::LearningParameters params;
+	File::ParametersParser::loadParametersFromJson(paramFile, params);
+	MujocoParameters mujocoParams;
+	mujocoParams.loadFromJson(paramFile);
+
+	// Must be the task and the activation function of the generation
+	std::unique_ptr<MujocoWrapper> mujocoLEPtr(task->create(activation, xmlFile));
+	MujocoWrapper& mujocoLE = *mujocoLEPtr;
+	mujocoLE.frame_skip_ = mujocoParams.frameSkip;
+	if (mujocoLE.m_->nu != MUJOCOTPG_NB_CONTINUOUS_ACTIONS) {
+		std::cout << "The generated code fills " << MUJOCOTPG_NB_CONTINUOUS_ACTIONS << " actions, the task has " << mujocoLE.m_->nu << " actuators." << std::endl;
+		exit(1);
+	}
+
+	/// fetch data in the environment
+	auto dataSources = mujocoLE.getDataSources();
+	auto& st = dataSources.at(0).get();
+	auto dataSharedPointer = st.getDataAt(typeid(double), 0).getSharedPointer<double>();
+	in1 = dataSharedPointer.get();
+
+	std::vector<double> actions(MUJOCOTPG_NB_CONTINUOUS_ACTIONS);
+	uint64_t totalNbActions = 0;
+	double inferenceTime = 0.0;
+	for (uint64_t seed = 0; seed < nbEpisodes; seed++) {
+		mujocoLE.reset(seed, Learn::LearningMode::VALIDATION);
+		uint64_t nbActions = 0;
+		while (!mujocoLE.isTerminal() && nbActions < params.maxNbActionsPerEval) {
+			/// inference with generated C files
+			auto start = std::chrono::steady_clock::now();
+			inferenceContinuousTPG(actions.data());
+			auto stop = std::chrono::steady_clock::now();
+			inferenceTime += std::chrono::duration<double>(stop - start).count();
+
+			mujocoLE.step(actions);
+			nbActions++;
+		}
+		totalNbActions += nbActions;
+		std::cout << "Seed " << seed << ": score " << mujocoLE.getScore() << " in " << nbActions << " actions." << std::endl;
+	}
+
+	std::cout << std::setprecision(6) << "Infer. time: " << inferenceTime << " s for " << totalNbActions << " actions." << std::endl;
+	return 0;
+}
@@ -0,0 +1,66 @@
+#include <algorithm>
+
+#include "asyncFrameWriter.h"
+
+AsyncFrameWriter::AsyncFrameWriter(FrameSink* pSink, int pWidth, int pHeight, size_t pCapacity) :
+	FrameSink(pWidth, pHeight, 0), sink{pSink}, capacity{pCapacity}
+{
+	worker = std::thread(&AsyncFrameWriter::writeLoop, this);
+}
+
+AsyncFrameWriter::~AsyncFrameWriter()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		done = true;
+	}
+	frameQueued.notify_one();
+	worker.join();
+}
+
+void AsyncFrameWriter::writeFrame(const unsigned char* rgb)
+{
+	std::vector<unsigned char> buffer;
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		frameWritten.wait(lock, [this] { return queue.size() < capacity; });
+		if (!freeBuffers.empty()) {
+			buffer.swap(freeBuffers.back());
+			freeBuffers.pop_back();
+		}
+	}
+
+	// Copy outside of the lock, the encoder keeps running meanwhile.
+	const size_t frameSize = (size_t)3 * width * height;
+	buffer.resize(frameSize);
+	std::copy(rgb, rgb + frameSize, buffer.begin());
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		queue.push_back(std::move(buffer));
+	}
+	frameQueued.notify_one();
+}
+
+void AsyncFrameWriter::writeLoop()
+{
+	std::vector<unsigned char> buffer;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			if (!buffer.empty()) {
+				freeBuffers.push_back(std::move(buffer));
+			}
+			frameQueued.wait(lock, [this] { return !queue.empty() || done; });
+			if (queue.empty()) {
+				// done and nothing left to write
+				return;
+			}
+			buffer = std::move(queue.front());
+			queue.pop_front();
+		}
+		frameWritten.notify_one();
+
+		sink->writeFrame(buffer.data());
+	}
+}
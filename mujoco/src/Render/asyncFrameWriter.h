@@ -0,0 +1,64 @@
+#ifndef ASYNCFRAMEWRITER_H
+#define ASYNCFRAMEWRITER_H
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "frameSink.h"
+
+/**
+* \brief FrameSink writing the frames in another FrameSink from a background
+* thread.
+*
+* writeFrame() copies the frame in a queue and returns, so that the
+* rendering of the next frames overlaps with the encoding. The queue is
+* bounded: when it is full, writeFrame() waits for the encoder to catch up.
+* Frame buffers are recycled, no allocation happens once the queue is full.
+*/
+class AsyncFrameWriter : public FrameSink
+{
+protected:
+	/// Sink in which the frames are written by the background thread.
+	std::unique_ptr<FrameSink> sink;
+
+	/// Maximum number of frames waiting to be written.
+	const size_t capacity;
+
+	/// Frames waiting to be written, in order.
+	std::deque<std::vector<unsigned char>> queue;
+
+	/// Buffers of already written frames, ready to be reused.
+	std::vector<std::vector<unsigned char>> freeBuffers;
+
+	/// Set when no more frames will be queued.
+	bool done = false;
+
+	std::mutex mutex;
+	std::condition_variable frameQueued;
+	std::condition_variable frameWritten;
+
+	std::thread worker;
+
+	/// Body of the background thread.
+	void writeLoop();
+
+public:
+	/**
+	* \brief Start the background thread.
+	*
+	* \param[in] pSink sink in which frames are written, owned by the writer.
+	* \param[in] pCapacity maximum number of queued frames.
+	*/
+	AsyncFrameWriter(FrameSink* pSink, int pWidth, int pHeight, size_t pCapacity = 8);
+
+	/// Write all the queued frames, then stop the thread and close the sink.
+	virtual ~AsyncFrameWriter();
+
+	virtual void writeFrame(const unsigned char* rgb) override;
+};
+
+#endif // !ASYNCFRAMEWRITER_H
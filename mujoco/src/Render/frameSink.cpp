@@ -0,0 +1,85 @@
+#include <iostream>
+#include <sstream>
+
+#include <mujoco.h>
+
+#include "frameSink.h"
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#define PIPE_WRITE_MODE "wb"
+#else
+#define PIPE_WRITE_MODE "w"
+#endif
+
+FFmpegFrameSink::FFmpegFrameSink(const std::string& outputPath, int pWidth, int pHeight, int pFps) :
+	FrameSink(pWidth, pHeight, pFps)
+{
+	// yuv420p needs even dimensions, the scale filter crops the last
+	// row/column if needed.
+	std::stringstream command;
+	command << "ffmpeg -y -loglevel error"
+		<< " -f rawvideo -pix_fmt rgb24 -s " << width << "x" << height << " -r " << fps << " -i -"
+		<< " -vf \"vflip,scale=trunc(iw/2)*2:trunc(ih/2)*2\""
+		<< " -vcodec libx264 -crf 25 -pix_fmt yuv420p \"" << outputPath << "\"";
+	std::cout << "Executing: " << command.str() << std::endl;
+
+	pipe = popen(command.str().c_str(), PIPE_WRITE_MODE);
+	if (pipe == NULL) {
+		mju_error("Could not launch ffmpeg");
+	}
+}
+
+FFmpegFrameSink::~FFmpegFrameSink()
+{
+	int result = pclose(pipe);
+	if (result != 0) {
+		std::cerr << "Error executing video generation command: " << result << std::endl;
+	}
+}
+
+void FFmpegFrameSink::writeFrame(const unsigned char* rgb)
+{
+	fwrite(rgb, 1, (size_t)3 * width * height, pipe);
+}
+
+Y4MFrameSink::Y4MFrameSink(const std::string& outputPath, int pWidth, int pHeight, int pFps) :
+	FrameSink(pWidth, pHeight, pFps), planes((size_t)3 * pWidth * pHeight)
+{
+	file = fopen(outputPath.c_str(), "wb");
+	if (file == NULL) {
+		char error[1100];
+		snprintf(error, sizeof(error), "Could not open %s", outputPath.c_str());
+		mju_error(error);
+	}
+	fprintf(file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n", width, height, fps);
+}
+
+Y4MFrameSink::~Y4MFrameSink()
+{
+	fclose(file);
+}
+
+void Y4MFrameSink::writeFrame(const unsigned char* rgb)
+{
+	const size_t planeSize = (size_t)width * height;
+	unsigned char* y = planes.data();
+	unsigned char* u = y + planeSize;
+	unsigned char* v = u + planeSize;
+
+	// BT.601 limited range, with rows flipped to get a top-down image.
+	for (int row = 0; row < height; row++) {
+		const unsigned char* src = rgb + (size_t)3 * width * (height - 1 - row);
+		size_t dst = (size_t)width * row;
+		for (int col = 0; col < width; col++, src += 3, dst++) {
+			int r = src[0], g = src[1], b = src[2];
+			y[dst] = (unsigned char)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+			u[dst] = (unsigned char)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+			v[dst] = (unsigned char)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+		}
+	}
+
+	fputs("FRAME\n", file);
+	fwrite(planes.data(), 1, planes.size(), file);
+}
@@ -0,0 +1,94 @@
+#ifndef FRAMESINK_H
+#define FRAMESINK_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+* \brief Destination of the frames rendered by the renderer.
+*
+* Frames are packed RGB images, with rows stored bottom-up, as returned by
+* mjr_readPixels(). The sink is responsible for flipping them.
+*/
+class FrameSink
+{
+protected:
+	/// Width of the frames in pixels.
+	const int width;
+
+	/// Height of the frames in pixels.
+	const int height;
+
+	/// Number of frames per second of the output video.
+	const int fps;
+
+public:
+	FrameSink(int pWidth, int pHeight, int pFps) : width{pWidth}, height{pHeight}, fps{pFps} {};
+
+	virtual ~FrameSink() {};
+
+	/**
+	* \brief Write a frame.
+	*
+	* \param[in] rgb width * height * 3 bytes, rows stored bottom-up.
+	*/
+	virtual void writeFrame(const unsigned char* rgb) = 0;
+};
+
+/**
+* \brief Stream raw frames to a single ffmpeg process through a pipe.
+*
+* ffmpeg flips and encodes the frames in H.264, no intermediate file is
+* written on disk.
+*/
+class FFmpegFrameSink : public FrameSink
+{
+protected:
+	/// Pipe to the standard input of ffmpeg.
+	FILE* pipe = NULL;
+
+public:
+	/**
+	* \brief Launch the ffmpeg process.
+	*
+	* \param[in] outputPath path of the encoded video.
+	*/
+	FFmpegFrameSink(const std::string& outputPath, int pWidth, int pHeight, int pFps = 60);
+
+	/// Close the pipe and wait for ffmpeg to finish the encoding.
+	virtual ~FFmpegFrameSink();
+
+	virtual void writeFrame(const unsigned char* rgb) override;
+};
+
+/**
+* \brief Write the frames in an uncompressed YUV4MPEG2 (Y4M) file.
+*
+* Frames are converted to YUV 4:4:4 (BT.601), which most players and
+* encoders read directly. This sink needs no external program.
+*/
+class Y4MFrameSink : public FrameSink
+{
+protected:
+	/// Output file.
+	FILE* file = NULL;
+
+	/// Y, U and V planes of the frame being written.
+	std::vector<unsigned char> planes;
+
+public:
+	/**
+	* \brief Open the output file and write the stream header.
+	*
+	* \param[in] outputPath path of the .y4m file.
+	*/
+	Y4MFrameSink(const std::string& outputPath, int pWidth, int pHeight, int pFps = 60);
+
+	/// Close the output file.
+	virtual ~Y4MFrameSink();
+
+	virtual void writeFrame(const unsigned char* rgb) override;
+};
+
+#endif // !FRAMESINK_H
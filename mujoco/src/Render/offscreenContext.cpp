@@ -0,0 +1,115 @@
+#include <mujoco.h>
+
+#include "offscreenContext.h"
+
+#if defined(MJ_EGL)
+#include <EGL/egl.h>
+
+static EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+static EGLContext eglContext = EGL_NO_CONTEXT;
+
+#elif defined(MJ_OSMESA)
+#include <GL/osmesa.h>
+
+static OSMesaContext osmesaContext = NULL;
+
+// OSMesa needs a default buffer to make the context current, even though
+// MuJoCo renders in its own framebuffer object.
+static unsigned char osmesaBuffer[4 * 16 * 16];
+
+#else
+#include <GLFW/glfw3.h>
+
+static GLFWwindow* invisibleWindow = NULL;
+#endif
+
+void initOffscreenContext()
+{
+#if defined(MJ_EGL)
+	const EGLint configAttribs[] = {
+		EGL_RED_SIZE,           8,
+		EGL_GREEN_SIZE,         8,
+		EGL_BLUE_SIZE,          8,
+		EGL_ALPHA_SIZE,         8,
+		EGL_DEPTH_SIZE,         24,
+		EGL_STENCIL_SIZE,       8,
+		EGL_COLOR_BUFFER_TYPE,  EGL_RGB_BUFFER,
+		EGL_SURFACE_TYPE,       EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE,    EGL_OPENGL_BIT,
+		EGL_NONE
+	};
+
+	eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	if (eglDisplay == EGL_NO_DISPLAY) {
+		mju_error("Could not get EGL display");
+	}
+
+	EGLint major, minor;
+	if (eglInitialize(eglDisplay, &major, &minor) != EGL_TRUE) {
+		mju_error("Could not initialize EGL");
+	}
+
+	EGLint nbConfigs;
+	EGLConfig eglConfig;
+	if (eglChooseConfig(eglDisplay, configAttribs, &eglConfig, 1, &nbConfigs) != EGL_TRUE || nbConfigs == 0) {
+		mju_error("Could not choose EGL config");
+	}
+
+	if (eglBindAPI(EGL_OPENGL_API) != EGL_TRUE) {
+		mju_error("Could not bind EGL OpenGL API");
+	}
+
+	eglContext = eglCreateContext(eglDisplay, eglConfig, EGL_NO_CONTEXT, NULL);
+	if (eglContext == EGL_NO_CONTEXT) {
+		mju_error("Could not create EGL context");
+	}
+
+	// No surface: MuJoCo renders in its offscreen framebuffer object
+	if (eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, eglContext) != EGL_TRUE) {
+		mju_error("Could not make EGL context current");
+	}
+
+#elif defined(MJ_OSMESA)
+	osmesaContext = OSMesaCreateContextExt(GL_RGBA, 24, 8, 8, 0);
+	if (!osmesaContext) {
+		mju_error("Could not create OSMesa context");
+	}
+
+	if (OSMesaMakeCurrent(osmesaContext, osmesaBuffer, GL_UNSIGNED_BYTE, 16, 16) != GL_TRUE) {
+		mju_error("Could not make OSMesa context current");
+	}
+
+#else
+	if (!glfwInit()) {
+		mju_error("Could not initialize GLFW");
+	}
+
+	glfwWindowHint(GLFW_VISIBLE, 0);
+	glfwWindowHint(GLFW_DOUBLEBUFFER, GLFW_FALSE);
+	invisibleWindow = glfwCreateWindow(16, 16, "Invisible window", NULL, NULL);
+	if (!invisibleWindow) {
+		mju_error("Could not create GLFW window");
+	}
+	glfwMakeContextCurrent(invisibleWindow);
+#endif
+}
+
+void closeOffscreenContext()
+{
+#if defined(MJ_EGL)
+	eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	eglDestroyContext(eglDisplay, eglContext);
+	eglTerminate(eglDisplay);
+
+#elif defined(MJ_OSMESA)
+	OSMesaDestroyContext(osmesaContext);
+
+#else
+	glfwDestroyWindow(invisibleWindow);
+
+	// Terminate GLFW (crashes with Linux NVidia drivers)
+#if defined(__APPLE__) || defined(_WIN32)
+	glfwTerminate();
+#endif
+#endif
+}
@@ -0,0 +1,21 @@
+#ifndef OFFSCREENCONTEXT_H
+#define OFFSCREENCONTEXT_H
+
+/**
+* \brief Create an OpenGL context without display, and make it current.
+*
+* The backend is selected at compile time with the RENDER_BACKEND CMake
+* option:
+* - EGL (MJ_EGL defined): hardware accelerated headless rendering.
+* - OSMESA (MJ_OSMESA defined): software rendering, no GPU needed.
+* - GLFW (default): invisible window, still needs an X server.
+*
+* MuJoCo renders in its own offscreen buffer, so the context needs no
+* surface of its own.
+*/
+void initOffscreenContext();
+
+/// Release the context created by initOffscreenContext().
+void closeOffscreenContext();
+
+#endif // !OFFSCREENCONTEXT_H
@@ -0,0 +1,91 @@
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+#include <GL/glext.h>
+
+#include "pboFrameReader.h"
+
+PboFrameReader::PboFrameReader(int pWidth, int pHeight) : width{pWidth}, height{pHeight}
+{
+	glGenBuffers(2, pbos);
+	for (int i = 0; i < 2; i++) {
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[i]);
+		glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)3 * width * height, NULL, GL_STREAM_READ);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+PboFrameReader::~PboFrameReader()
+{
+	unmap();
+	glDeleteBuffers(2, pbos);
+}
+
+void PboFrameReader::unmap()
+{
+	if (mapped >= 0) {
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[mapped]);
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		mapped = -1;
+	}
+}
+
+const unsigned char* PboFrameReader::map(int pbo)
+{
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[pbo]);
+	const unsigned char* pixels = (const unsigned char*)glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	mapped = pbo;
+	nbPending--;
+	return pixels;
+}
+
+const unsigned char* PboFrameReader::readFrame(const mjrContext* con)
+{
+	unmap();
+
+	// Select the buffer to read from, as mjr_readPixels does.
+	if (con->currentBuffer == mjFB_OFFSCREEN) {
+		if (con->offSamples) {
+			// Resolve the multisampled buffer first
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, con->offFBO);
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, con->offFBO_r);
+			glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, con->offFBO_r);
+		}
+		else {
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, con->offFBO);
+		}
+	}
+	else {
+		glReadBuffer(GL_BACK);
+	}
+
+	// Start the asynchronous copy in the current PBO
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[index]);
+	glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, 0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	if (con->currentBuffer == mjFB_OFFSCREEN) {
+		glBindFramebuffer(GL_FRAMEBUFFER, con->offFBO);
+	}
+
+	nbPending++;
+	index = 1 - index;
+
+	// The other PBO holds the previous frame
+	if (nbPending < 2) {
+		return NULL;
+	}
+	return map(index);
+}
+
+const unsigned char* PboFrameReader::flush()
+{
+	unmap();
+	if (nbPending == 0) {
+		return NULL;
+	}
+	return map(1 - index);
+}
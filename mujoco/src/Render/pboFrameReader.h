@@ -0,0 +1,67 @@
+#ifndef PBOFRAMEREADER_H
+#define PBOFRAMEREADER_H
+
+#include <mujoco.h>
+
+/**
+* \brief Asynchronous readback of the rendered frames with two pixel buffer
+* objects (PBO).
+*
+* glReadPixels into a PBO returns immediately, the copy from the GPU is done
+* in the background. Each call to readFrame() starts the readback of the
+* current frame in one PBO and maps the other one, which holds the previous
+* frame, whose copy had the whole rendering of a frame to complete.
+*
+* An OpenGL context must be current during the whole life of the object.
+*/
+class PboFrameReader
+{
+protected:
+	/// Size of the read rectangle.
+	const int width;
+	const int height;
+
+	/// The two pixel buffer objects.
+	unsigned int pbos[2];
+
+	/// Index of the PBO receiving the next frame.
+	int index = 0;
+
+	/// Number of frames whose readback was started but not returned.
+	int nbPending = 0;
+
+	/// PBO currently mapped, or -1.
+	int mapped = -1;
+
+	/// Unmap the PBO mapped by the last readFrame() or flush() call.
+	void unmap();
+
+	/// Map a PBO and return a pointer to its content.
+	const unsigned char* map(int pbo);
+
+public:
+	/// Allocate the two PBOs for frames of width x height pixels.
+	PboFrameReader(int pWidth, int pHeight);
+
+	/// Free the PBOs.
+	~PboFrameReader();
+
+	/**
+	* \brief Start the readback of the frame just rendered.
+	*
+	* \param[in] con MuJoCo context in which the frame was rendered.
+	* \return the RGB pixels of the previous frame, rows bottom-up, or NULL on
+	* the first call. The pointer is valid until the next call.
+	*/
+	const unsigned char* readFrame(const mjrContext* con);
+
+	/**
+	* \brief Wait for the readback of the last frame.
+	*
+	* \return the RGB pixels of the last frame given to readFrame(), or NULL
+	* if it was already returned. The pointer is valid until the next call.
+	*/
+	const unsigned char* flush();
+};
+
+#endif // !PBOFRAMEREADER_H
@@ -0,0 +1,126 @@
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+// The AVX2 kernels are compiled for AVX2 and FMA whatever the flags of the
+// target, and only called if the CPU supports them.
+#include <immintrin.h>
+#define REWARD_KERNELS_AVX2
+#define REWARD_KERNELS_RUNTIME_DISPATCH
+#define AVX2_TARGET __attribute__((target("avx2,fma")))
+#elif defined(__AVX2__)
+// The whole target is compiled for AVX2 (e.g. /arch:AVX2 with MSVC).
+#include <immintrin.h>
+#define REWARD_KERNELS_AVX2
+#define AVX2_TARGET
+#endif
+
+#include "rewardKernels.h"
+
+#ifdef REWARD_KERNELS_AVX2
+/// Whether the AVX2 kernels can run on this CPU.
+static bool isAvx2Supported()
+{
+#ifdef REWARD_KERNELS_RUNTIME_DISPATCH
+	static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+	return supported;
+#else
+	return true;
+#endif
+}
+
+/// Horizontal sum of the four doubles of an AVX register.
+AVX2_TARGET static inline double horizontalSum(__m256d v)
+{
+	__m128d low = _mm256_castpd256_pd128(v);
+	__m128d high = _mm256_extractf128_pd(v, 1);
+	low = _mm_add_pd(low, high);
+	__m128d swapped = _mm_unpackhi_pd(low, low);
+	return _mm_cvtsd_f64(_mm_add_sd(low, swapped));
+}
+
+/// acc + v * v, fused if FMA is available.
+AVX2_TARGET static inline __m256d accumulateSquare(__m256d acc, __m256d v)
+{
+#if defined(REWARD_KERNELS_RUNTIME_DISPATCH) || defined(__FMA__)
+	return _mm256_fmadd_pd(v, v, acc);
+#else
+	return _mm256_add_pd(acc, _mm256_mul_pd(v, v));
+#endif
+}
+
+/**
+* \brief Sum of the squares of the values, by blocks of four.
+*
+* \param[in,out] i index of the first value, set to the first value left
+* for the scalar loop.
+*/
+AVX2_TARGET static double sumSquaresAvx2(const double* values, size_t size, size_t& i)
+{
+	// Two accumulators to hide the latency of the additions.
+	__m256d acc0 = _mm256_setzero_pd();
+	__m256d acc1 = _mm256_setzero_pd();
+	for (; i + 8 <= size; i += 8) {
+		acc0 = accumulateSquare(acc0, _mm256_loadu_pd(values + i));
+		acc1 = accumulateSquare(acc1, _mm256_loadu_pd(values + i + 4));
+	}
+	for (; i + 4 <= size; i += 4) {
+		acc0 = accumulateSquare(acc0, _mm256_loadu_pd(values + i));
+	}
+	return horizontalSum(_mm256_add_pd(acc0, acc1));
+}
+
+/// Same as sumSquaresAvx2(), with the values clamped in [low, high].
+AVX2_TARGET static double clampedSumSquaresAvx2(const double* values, size_t size, double low, double high, size_t& i)
+{
+	const __m256d vLow = _mm256_set1_pd(low);
+	const __m256d vHigh = _mm256_set1_pd(high);
+	__m256d acc0 = _mm256_setzero_pd();
+	__m256d acc1 = _mm256_setzero_pd();
+	for (; i + 8 <= size; i += 8) {
+		__m256d v0 = _mm256_max_pd(vLow, _mm256_min_pd(_mm256_loadu_pd(values + i), vHigh));
+		__m256d v1 = _mm256_max_pd(vLow, _mm256_min_pd(_mm256_loadu_pd(values + i + 4), vHigh));
+		acc0 = accumulateSquare(acc0, v0);
+		acc1 = accumulateSquare(acc1, v1);
+	}
+	for (; i + 4 <= size; i += 4) {
+		__m256d v = _mm256_max_pd(vLow, _mm256_min_pd(_mm256_loadu_pd(values + i), vHigh));
+		acc0 = accumulateSquare(acc0, v);
+	}
+	return horizontalSum(_mm256_add_pd(acc0, acc1));
+}
+#endif
+
+double RewardKernels::sumSquares(const double* values, size_t size)
+{
+	size_t i = 0;
+	double sum = 0.0;
+
+#ifdef REWARD_KERNELS_AVX2
+	if (isAvx2Supported()) {
+		sum = sumSquaresAvx2(values, size, i);
+	}
+#endif
+
+	for (; i < size; i++) {
+		sum += values[i] * values[i];
+	}
+	return sum;
+}
+
+double RewardKernels::clampedSumSquares(const double* values, size_t size, double low, double high)
+{
+	size_t i = 0;
+	double sum = 0.0;
+
+#ifdef REWARD_KERNELS_AVX2
+	if (isAvx2Supported()) {
+		sum = clampedSumSquaresAvx2(values, size, low, high, i);
+	}
+#endif
+
+	for (; i < size; i++) {
+		double v = std::max(low, std::min(values[i], high));
+		sum += v * v;
+	}
+	return sum;
+}
@@ -0,0 +1,42 @@
+#ifndef REWARDKERNELS_H
+#define REWARDKERNELS_H
+
+#include <cstddef>
+
+/**
+* \brief Reduction kernels shared by the reward functions of MuJoCo tasks.
+*
+* On CPUs supporting AVX2 and FMA, the kernels process four doubles per
+* instruction. With GCC and Clang on x86, the AVX2 version is selected at
+* runtime. With other compilers, it is only used if the target is compiled
+* for AVX2 (MUJOCO_AVX2 CMake option). Otherwise, a scalar implementation
+* is used. The order of the additions differs between the two versions, so
+* their results may differ in the last bits.
+*/
+namespace RewardKernels
+{
+	/**
+	* \brief Compute the sum of the squares of the values.
+	*
+	* Used for control costs: sum(a_i^2).
+	*
+	* \param[in] values pointer to the first value.
+	* \param[in] size number of values.
+	*/
+	double sumSquares(const double* values, size_t size);
+
+	/**
+	* \brief Compute the sum of the squares of the values clamped in [low, high].
+	*
+	* Used for contact costs: sum(clamp(f_i, low, high)^2). The clamped values
+	* are not stored.
+	*
+	* \param[in] values pointer to the first value.
+	* \param[in] size number of values.
+	* \param[in] low lower bound of the clamp.
+	* \param[in] high upper bound of the clamp.
+	*/
+	double clampedSumSquares(const double* values, size_t size, double low, double high);
+}
+
+#endif // !REWARDKERNELS_H
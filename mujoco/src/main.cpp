@@ -9,8 +9,11 @@
 #define _USE_MATH_DEFINES // To get M_PI
 #include <math.h>
 
-#include "mujocoAntWrapper.h"
+#include "mujocoTaskRegistry.h"
 #include "instructions.h"
+#include "mujocoParameters.h"
+#include "validationCacheLearningAgent.h"
+#include "asyncDotExporter.h"
 
 int main(int argc, char ** argv) {
 
@@ -19,18 +22,39 @@ int main(int argc, char ** argv) {
     char paramFile[150];
 	char logsFolder[150];
 	char xmlFile[150];
+	char taskName[150];
+    // Checkpoint a dot file every dotPeriod generations, keep the last dotNbKept (0 for all)
+    uint64_t dotPeriod = 100;
+    size_t dotNbKept = 0;
     strcpy(logsFolder, "logs");
     strcpy(paramFile, "params/params_0.json");
-    strcpy(xmlFile, "mujoco_models/ant.xml");
-    while((option = getopt(argc, argv, "s:p:l:x:")) != -1){
+    strcpy(xmlFile, "");
+    strcpy(taskName, "ant");
+    while((option = getopt(argc, argv, "s:p:l:x:t:d:k:")) != -1){
         switch (option) {
             case 's': seed= atoi(optarg); break;
             case 'p': strcpy(paramFile, optarg); break;
             case 'l': strcpy(logsFolder, optarg); break;
             case 'x': strcpy(xmlFile, optarg); break;
-            default: std::cout << "Unrecognised option. Valid options are \'-s seed\' \'-p paramFile.json\' \'-logs logs Folder\'  \'-x xmlFile\'." << std::endl; exit(1);
+            case 't': strcpy(taskName, optarg); break;
+            case 'd': dotPeriod = atoll(optarg); break;
+            case 'k': dotNbKept = atoll(optarg); break;
+            default: std::cout << "Unrecognised option. Valid options are \'-s seed\' \'-p paramFile.json\' \'-logs logs Folder\'  \'-x xmlFile\' \'-t task\' \'-d dotPeriod\' \'-k nbKeptDots\'." << std::endl; exit(1);
         }
     }
+    const MujocoTask* task = findMujocoTask(taskName);
+    if(task == NULL){
+        std::cout << "Unknown task " << taskName << ". Valid tasks are:";
+        for(const MujocoTask& t : getMujocoTasks()){
+            std::cout << " " << t.name;
+        }
+        std::cout << "." << std::endl;
+        exit(1);
+    }
+    if(strlen(xmlFile) == 0){
+        strcpy(xmlFile, task->defaultXmlFile.c_str());
+    }
+    std::cout << "Selected task: " << task->name << " (" << xmlFile << ")" << std::endl;
     std::cout << "Selected seed : " << seed << std::endl;
     std::cout << "Selected params: " << paramFile << std::endl;
 
@@ -49,14 +73,22 @@ int main(int argc, char ** argv) {
 	// Loads them from the file params.json
 	Learn::LearningParameters params;
 	File::ParametersParser::loadParametersFromJson(paramFile, params);
+	MujocoParameters mujocoParams;
+	mujocoParams.loadFromJson(paramFile);
 
 	// Instantiate the LearningEnvironment
-	MujocoAntWrapper mujocoAntLE(std::string("none"), xmlFile);
+	std::unique_ptr<MujocoWrapper> mujocoLEPtr(task->create("none", xmlFile));
+	MujocoWrapper& mujocoLE = *mujocoLEPtr;
+	mujocoLE.frame_skip_ = mujocoParams.frameSkip;
 
 	std::cout << "Number of threads: " << params.nbThreads << std::endl;
 
+	// Preallocate the mjData of the environments cloned for each thread.
+	mujocoLE.reserve_instances(params.nbThreads + 1);
+
 	// Instantiate and init the learning agent
-	Learn::ParallelLearningAgent la(mujocoAntLE, set, params);
+	// (Validation scores of unchanged roots are reused across generations)
+	ValidationCacheLearningAgent<> la(mujocoLE, set, params);
 	la.init(seed);
 
 
@@ -76,9 +108,7 @@ int main(int argc, char ** argv) {
     Log::LABasicLogger log(la, logStream);
 
 	// Create an exporter for all graphs
-    char dotPath[250];
-    sprintf(dotPath, "%s/out_0000.%" PRIu64 ".p%d.dot", logsFolder, seed, indexParam);
-	File::TPGGraphDotExporter dotExporter(dotPath, *la.getTPGGraph());
+	AsyncDotExporter dotExporter(*la.getTPGGraph(), dotPeriod, dotNbKept);
 
 	// Logging best policy stat.
     char bestPolicyStatsPath[250];
@@ -99,12 +129,9 @@ int main(int argc, char ** argv) {
 	for (uint64_t i = 0; i < params.nbGenerations && !exitProgram; i++) {
 #define PRINT_ALL_DOT 1
 #if PRINT_ALL_DOT
-		if(i % 100 == 0){
-			char buff[250];
-			sprintf(buff, "%s/out_%04d.%" PRIu64 ".p%d.dot", logsFolder, (int)i, seed, indexParam);
-			dotExporter.setNewFilePath(buff);
-			dotExporter.print();
-		}
+		char buff[250];
+		sprintf(buff, "%s/out_%04d.%" PRIu64 ".p%d.dot", logsFolder, (int)i, seed, indexParam);
+		dotExporter.checkpoint(i, buff);
 
 #endif
 
@@ -112,14 +139,17 @@ int main(int argc, char ** argv) {
 		la.trainOneGeneration(i);
 	}
 
+	// Wait for the checkpoints, they share their programs with the graph.
+	dotExporter.flush();
+
 	// Keep best policy
 	la.keepBestPolicy();
 
     char bestDot[250];
 	// Export the graph
     sprintf(bestDot, "%s/out_best.%" PRIu64 ".p%d.dot", logsFolder, seed, indexParam);
-	dotExporter.setNewFilePath(bestDot);
-	dotExporter.print();
+	dotExporter.exportGraph(bestDot);
+	dotExporter.flush();
 
 	TPG::PolicyStats ps;
 	ps.setEnvironment(la.getTPGGraph()->getEnvironment());
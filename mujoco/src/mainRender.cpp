@@ -10,8 +10,8 @@
 #include <getopt.h>
 
 #include "mainRender.h"
-#include <glfw3.h>
 
+#ifdef RENDER_WINDOW
 // keyboard callback
 void keyboard(GLFWwindow* window, int key, int scancode, int act, int mods) {
     // backspace: reset simulation
@@ -76,22 +76,36 @@ void scroll(GLFWwindow* window, double xoffset, double yoffset) {
     mjv_moveCamera(m, mjMOUSE_ZOOM, 0, -0.05 * yoffset, &scn, &cam);
 }
 
-void InitVisualization(mjModel* task_m, mjData* task_d) {
+#endif
+
+void InitVisualization(const mjModel* task_m, mjData* task_d, bool isOffscreen, bool vsync) {
     m = task_m;
     d = task_d;
+    offscreen = isOffscreen;
+
+#ifndef RENDER_WINDOW
+    if (!offscreen) {
+        mju_error("Rendering in a window needs the GLFW render backend");
+    }
+#endif
 
-    // init GLFW
-    if (!glfwInit()) {
-        mju_error("Could not initialize GLFW");
+    if (offscreen) {
+        // create headless OpenGL context
+        initOffscreenContext();
     }
+#ifdef RENDER_WINDOW
+    else {
+        // init GLFW
+        if (!glfwInit()) {
+            mju_error("Could not initialize GLFW");
+        }
 
-    // create window, make OpenGL context current, request v-sync
-    // GLFWwindow* window = glfwCreateWindow(1200, 900, "Demo", NULL, NULL);
-    window = glfwCreateWindow(1200, 900, "Demo", NULL, NULL);
-    std::cout << "WINDOW1:";
-    std::cout << glfwWindowShouldClose(window) << std::endl;
-    glfwMakeContextCurrent(window);
-    glfwSwapInterval(1);
+        // create window, make OpenGL context current, request v-sync
+        window = glfwCreateWindow(1200, 900, "Demo", NULL, NULL);
+        glfwMakeContextCurrent(window);
+        glfwSwapInterval(vsync ? 1 : 0);
+    }
+#endif
 
     // initialize visualization data structures
     mjv_defaultCamera(&cam);
@@ -101,65 +115,94 @@ void InitVisualization(mjModel* task_m, mjData* task_d) {
 
     // create scene and context
     mjv_makeScene(m, &scn, 2000);
-    mjr_makeContext(m, &con, mjFONTSCALE_150);
+    if (offscreen) {
+        // The size of the offscreen buffer is read from the model, which is
+        // shared with the environment: set it on a private copy.
+        offscreenModel = mj_copyModel(NULL, m);
+        offscreenModel->vis.global.offwidth = offscreenWidth;
+        offscreenModel->vis.global.offheight = offscreenHeight;
+        mjr_makeContext(offscreenModel, &con, mjFONTSCALE_150);
+        mjr_setBuffer(mjFB_OFFSCREEN, &con);
+    }
+    else {
+        mjr_makeContext(m, &con, mjFONTSCALE_150);
+    }
 
-    // install GLFW mouse and keyboard callbacks
-    glfwSetKeyCallback(window, keyboard);
-    glfwSetCursorPosCallback(window, mouse_move);
-    glfwSetMouseButtonCallback(window, mouse_button);
-    glfwSetScrollCallback(window, scroll);
+#ifdef RENDER_WINDOW
+    if (!offscreen) {
+        // install GLFW mouse and keyboard callbacks
+        glfwSetKeyCallback(window, keyboard);
+        glfwSetCursorPosCallback(window, mouse_move);
+        glfwSetMouseButtonCallback(window, mouse_button);
+        glfwSetScrollCallback(window, scroll);
+    }
+#endif
 
-    std::cout << "WINDOW2:" << glfwWindowShouldClose(window) << std::endl;
+    // The frames keep this size even if the window is resized
+    frameViewport = GetViewport();
 }
 
-void StepVisualization(bool isRenderVideoSaved, const char* filePath) {
-    // Get framebuffer viewport
-    mjrRect viewport = {0, 0, 0, 0};
-    glfwGetFramebufferSize(window, &viewport.width, &viewport.height);
-
-    // Update scene and render
-    mjv_updateScene(m, d, &opt, NULL, &cam, mjCAT_ALL, &scn);
-    mjr_render(viewport, &scn, &con);
-
-    if(isRenderVideoSaved){
-        // Save the current frame
-        char filename[256];
-        sprintf(filename, "%s/frame_%04d.png", filePath, frame_count);
-        saveFrame(viewport.width, viewport.height, filename);
-        frame_count++;
+void CloseVisualization() {
+    frameReader.reset();
+    mjv_freeScene(&scn);
+    mjr_freeContext(&con);
+    if (offscreen) {
+        mj_deleteModel(offscreenModel);
+        closeOffscreenContext();
     }
+}
 
-
-    // Swap OpenGL buffers (blocking call due to v-sync)
-    glfwSwapBuffers(window);
-
-    // Process pending GUI events, call GLFW callbacks
-    glfwPollEvents();
+void FlushVisualization(FrameSink* sink) {
+    if (frameReader) {
+        const unsigned char* frame = frameReader->flush();
+        if (frame != NULL) {
+            sink->writeFrame(frame);
+        }
+    }
 }
 
-void saveFrame(int width, int height, const char* filename) {
-    // Allocate memory to store the pixels
-    unsigned char* pixels = (unsigned char*)malloc(3 * width * height);
-    if (!pixels) {
-        std::cerr << "Failed to allocate memory for image capture." << std::endl;
-        return;
+mjrRect GetViewport() {
+    mjrRect viewport = {0, 0, 0, 0};
+    if (offscreen) {
+        viewport.width = con.offWidth;
+        viewport.height = con.offHeight;
+    }
+#ifdef RENDER_WINDOW
+    else {
+        // Get framebuffer viewport
+        glfwGetFramebufferSize(window, &viewport.width, &viewport.height);
     }
+#endif
+    return viewport;
+}
+
+void StepVisualization(FrameSink* sink) {
+    mjrRect viewport = GetViewport();
 
-    // Read pixels from the OpenGL framebuffer
-    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+    // Update scene and render
+    mjv_updateScene(m, d, &opt, NULL, &cam, mjCAT_ALL, &scn);
+    mjr_render(viewport, &scn, &con);
 
-    // Flip the image vertically (OpenGL's origin is bottom-left)
-    for (int y = 0; y < height / 2; ++y) {
-        for (int x = 0; x < width * 3; ++x) {
-            std::swap(pixels[y * width * 3 + x], pixels[(height - 1 - y) * width * 3 + x]);
+    if (sink != NULL) {
+        // Start the readback of this frame, and get the previous one
+        if (!frameReader) {
+            frameReader.reset(new PboFrameReader(frameViewport.width, frameViewport.height));
+        }
+        const unsigned char* frame = frameReader->readFrame(&con);
+        if (frame != NULL) {
+            sink->writeFrame(frame);
         }
     }
 
-    // Save the image using stb_image_write
-    stbi_write_png(filename, width, height, 3, pixels, width * 3);
+#ifdef RENDER_WINDOW
+    if (!offscreen) {
+        // Swap OpenGL buffers (blocking call due to v-sync)
+        glfwSwapBuffers(window);
 
-    // Free the allocated memory
-    free(pixels);
+        // Process pending GUI events, call GLFW callbacks
+        glfwPollEvents();
+    }
+#endif
 }
 
 int main(int argc, char ** argv) {
@@ -168,15 +211,24 @@ int main(int argc, char ** argv) {
 	char dotPath[150];
     char paramFile[150];
     bool isRenderVideoSaved = false;
+    bool isOffscreen = false;
+    bool vsync = true;
     char pathRenderVideo[150];
+    char encoder[150];
 	char xmlFile[150];
+	char taskName[150];
     uint64_t seed=0;
     
     strcpy(dotPath, "logs/out_best.0.p0.v1.c0.dot");
     strcpy(paramFile, "params/params_0.json");
     strcpy(pathRenderVideo, "../logs/render");
-    strcpy(xmlFile, "mujoco_models/ant.xml");
-    while((option = getopt(argc, argv, "s:p:d:f:g:x:")) != -1){
+    strcpy(xmlFile, "");
+    strcpy(taskName, "ant");
+    strcpy(encoder, "ffmpeg");
+#ifndef RENDER_WINDOW
+    isOffscreen = true;
+#endif
+    while((option = getopt(argc, argv, "s:p:d:f:g:x:o:e:v:t:")) != -1){
         switch (option) {
             case 's': seed= atoi(optarg); break;
             case 'p': strcpy(paramFile, optarg); break;
@@ -184,9 +236,21 @@ int main(int argc, char ** argv) {
             case 'g': strcpy(pathRenderVideo, optarg); break;
             case 'f': isRenderVideoSaved= atoi(optarg); break;
             case 'x': strcpy(xmlFile, optarg); break;
-            default: std::cout << "Unrecognised option. Valid options are \'-s seed\' \'-p paramFile.json\' \'-d dot path\' \'-f save or not video\' \'-g path for video saved\' \'-x xmlFile\'." << std::endl; exit(1);
+            case 'o': isOffscreen= atoi(optarg); break;
+            case 'e': strcpy(encoder, optarg); break;
+            case 'v': vsync= atoi(optarg); break;
+            case 't': strcpy(taskName, optarg); break;
+            default: std::cout << "Unrecognised option. Valid options are \'-s seed\' \'-p paramFile.json\' \'-d dot path\' \'-f save or not video\' \'-g path for video saved\' \'-x xmlFile\' \'-o render offscreen\' \'-e encoder (ffmpeg or y4m)\' \'-v vsync\' \'-t task\'." << std::endl; exit(1);
         }
     }
+    const MujocoTask* task = findMujocoTask(taskName);
+    if(task == NULL){
+        std::cout << "Unknown task " << taskName << "." << std::endl;
+        exit(1);
+    }
+    if(strlen(xmlFile) == 0){
+        strcpy(xmlFile, task->defaultXmlFile.c_str());
+    }
 
 	std::cout << "Start Mujoco Rendering application." << std::endl;
     // Create the instruction set for programs
@@ -199,16 +263,20 @@ int main(int argc, char ** argv) {
 	// Loads them from the file params.json
 	Learn::LearningParameters params;
 	File::ParametersParser::loadParametersFromJson(paramFile, params);
+	MujocoParameters mujocoParams;
+	mujocoParams.loadFromJson(paramFile);
 
 	// Instantiate the LearningEnvironment
-	MujocoAntWrapper mujocoAntLE(std::string("none"), xmlFile);
+	std::unique_ptr<MujocoWrapper> mujocoLEPtr(task->create("none", xmlFile));
+	MujocoWrapper& mujocoLE = *mujocoLEPtr;
+	mujocoLE.frame_skip_ = mujocoParams.frameSkip;
 
 	// Instantiate and init the learning agent
-	Learn::ParallelLearningAgent la(mujocoAntLE, set, params);
+	Learn::ParallelLearningAgent la(mujocoLE, set, params);
 	la.init(seed);
 
     auto &tpg = *la.getTPGGraph();
-    Environment env(set, mujocoAntLE.getDataSources(), params.nbRegisters, params.nbProgramConstant, params.useMemoryRegisters);
+    Environment env(set, mujocoLE.getDataSources(), params.nbRegisters, params.nbProgramConstant, params.useMemoryRegisters);
     
     File::TPGGraphDotImporter dotImporter(dotPath, env, tpg);
     dotImporter.importGraph();
@@ -235,52 +303,47 @@ int main(int argc, char ** argv) {
 
     TPG::TPGExecutionEngine tee(env, NULL, false, 8);
 
-    mujocoAntLE.reset(seed, Learn::LearningMode::VALIDATION);
+    mujocoLE.reset(seed, Learn::LearningMode::VALIDATION);
+
+    InitVisualization(mujocoLE.m_, mujocoLE.d_, isOffscreen, vsync);
+
+    // Frames are streamed to the encoder, without intermediate files,
+    // from a background thread
+    std::unique_ptr<FrameSink> sink;
+    if(isRenderVideoSaved){
+        FrameSink* encoderSink;
+        if(strcmp(encoder, "y4m") == 0){
+            encoderSink = new Y4MFrameSink(std::string(pathRenderVideo) + "/output_video.y4m", frameViewport.width, frameViewport.height);
+        } else {
+            encoderSink = new FFmpegFrameSink(std::string(pathRenderVideo) + "/output_video.mp4", frameViewport.width, frameViewport.height);
+        }
+        sink.reset(new AsyncFrameWriter(encoderSink, frameViewport.width, frameViewport.height));
+    }
 
-    InitVisualization(mujocoAntLE.m_, mujocoAntLE.d_);
-    StepVisualization(isRenderVideoSaved, pathRenderVideo);
+    StepVisualization(sink.get());
 
 
     uint64_t nbActions = 0;
-    while (!mujocoAntLE.isTerminal() && nbActions < params.maxNbActionsPerEval) {
+    while (!mujocoLE.isTerminal() && nbActions < params.maxNbActionsPerEval) {
         // Get the actions
         std::vector<double> actionsID =
-            tee.executeFromRoot(*tpg.getRootVertices()[0], mujocoAntLE.getInitActions(),
+            tee.executeFromRoot(*tpg.getRootVertices()[0], mujocoLE.getInitActions(),
                                 1,
-                                mujocoAntLE.getActivationFunction()).second;
+                                mujocoLE.getActivationFunction()).second;
         // Do it
-        mujocoAntLE.doActions(actionsID);
+        mujocoLE.step(actionsID);
         // Count actions
         nbActions++;
-        StepVisualization(isRenderVideoSaved, pathRenderVideo);
+        StepVisualization(sink.get());
 
     }
 
-    if(isRenderVideoSaved){
-        // Change size of images and save
-        std::string resizeCommand = "ffmpeg -i " + std::string(pathRenderVideo) + "/frame_%04d.png -vf \"scale=1200:844\" " + std::string(pathRenderVideo) + "/resized_frame_%04d.png";
-        std::cout << "Executing: " << resizeCommand << std::endl;
-        int result = system(resizeCommand.c_str());
-        if (result != 0) {
-            std::cerr << "Error executing resize command: " << result << std::endl;
-        }
-
-        std::string videoCommand = "ffmpeg -y -r 60 -f image2 -s 1200:844 -i " + std::string(pathRenderVideo) + "/resized_frame_%04d.png -vcodec libx264 -crf 25 -pix_fmt yuv420p " + std::string(pathRenderVideo) + "/output_video.mp4";
-        std::cout << "Executing: " << videoCommand << std::endl;
-        result = system(videoCommand.c_str());
-        if (result != 0) {
-            std::cerr << "Error executing video generation command: " << result << std::endl;
-        }
-
-        std::string cleanupCommand = "rm " + std::string(pathRenderVideo) + "/frame_*.png " + std::string(pathRenderVideo) + "/resized_frame_*.png";
-        std::cout << "Executing: " << cleanupCommand << std::endl;
-        result = system(cleanupCommand.c_str());
-        if (result != 0) {
-            std::cerr << "Error executing cleanup command: " << result << std::endl;
-        }
+    // Finish the encoding before releasing the context
+    if(sink){
+        FlushVisualization(sink.get());
     }
-
-
+    sink.reset();
+    CloseVisualization();
 
     // cleanup
 	for (unsigned int i = 0; i < set.getNbInstructions(); i++) {
@@ -2,34 +2,50 @@
 #ifndef RENDER_MUJOCO_h
 #define RENDER_MUJOCO_h
 
-#include <GLFW/glfw3.h>
+#include <memory>
+
 #include <mujoco.h>
 
+// Without a GLFW backend, only the headless rendering is available.
+#if !defined(MJ_EGL) && !defined(MJ_OSMESA)
+#define RENDER_WINDOW
+#include <GLFW/glfw3.h>
+#endif
 
-#include "mujocoAntWrapper.h"
+#include "mujocoTaskRegistry.h"
 #include <gegelati.h>
 #include "instructions.h"
-
-#define STB_IMAGE_WRITE_IMPLEMENTATION
-#include "stb_image_write.h"
+#include "mujocoParameters.h"
+#include "Render/asyncFrameWriter.h"
+#include "Render/frameSink.h"
+#include "Render/offscreenContext.h"
+#include "Render/pboFrameReader.h"
 
 /******************************************************************************/
 // MuJoCo data structures
-mjModel* m = NULL;  // MuJoCo model
+const mjModel* m = NULL;  // MuJoCo model
 mjData* d = NULL;   // MuJoCo data
 mjvCamera cam;      // abstract camera
 mjvOption opt;      // visualization options
 mjvScene scn;       // abstract scene
 mjrContext con;     // custom GPU context
 
+// headless rendering
+bool offscreen = false;       // render in MuJoCo offscreen buffer
+mjModel* offscreenModel = NULL;  // copy of m with the offscreen buffer size
+int offscreenWidth = 1200;
+int offscreenHeight = 900;
+mjrRect frameViewport = {0, 0, 0, 0};  // size of the saved frames
+std::unique_ptr<PboFrameReader> frameReader;  // asynchronous frame readback
+
 // mouse interaction
 bool button_left = false;
 bool button_middle = false;
 bool button_right = false;
 double lastx = 0;
 double lasty = 0;
-int frame_count = 0;
 
+#ifdef RENDER_WINDOW
 GLFWwindow* window = 0;
 
 // keyboard callback
@@ -40,12 +56,34 @@ void mouse_button(GLFWwindow* window, int button, int act, int mods);
 
 // mouse move callback
 void mouse_move(GLFWwindow* window, double xpos, double ypos);
-
-void InitVisualization(mjModel* task_m, mjData* task_d);
-
-void saveFrame(int width, int height, const char* filename);
-
-void StepVisualization(bool isSaveFrame, const char* filePath="");
+#endif
+
+/**
+* \brief Create the OpenGL context and the MuJoCo visualization structures.
+*
+* \param[in] isOffscreen if true, render without display in the MuJoCo
+* offscreen buffer. Otherwise, render in a GLFW window.
+* \param[in] vsync if false, rendering in a window is not synchronized with
+* the display refresh rate.
+*/
+void InitVisualization(const mjModel* task_m, mjData* task_d, bool isOffscreen, bool vsync = true);
+
+/// Free the visualization structures and the OpenGL context.
+void CloseVisualization();
+
+/// Get the size of the rendered frames.
+mjrRect GetViewport();
+
+/**
+* \brief Render the current state of the simulation.
+*
+* \param[in] sink if not NULL, the rendered frame is read asynchronously
+* and written in it, one frame later.
+*/
+void StepVisualization(FrameSink* sink = NULL);
+
+/// Write in the sink the last frame still being read back.
+void FlushVisualization(FrameSink* sink);
 
 
 
@@ -2,22 +2,16 @@
 #include <math.h>
 
 #include "mujocoAntWrapper.h"
-
-
+#include "RewardKernels/rewardKernels.h"
 
 
 void MujocoAntWrapper::reset(size_t seed, Learn::LearningMode mode, uint16_t iterationNumber, uint64_t generationNumber)
 {
-	// Create seed from seed and mode
-	size_t hash_seed = Data::Hash<size_t>()(seed) ^ Data::Hash<Learn::LearningMode>()(mode);
-	if(mode == Learn::LearningMode::VALIDATION){
-		hash_seed = 6416846135168433;
+	reset_rng(seed, mode);
+	if (restore_initial_state()) {
+		return;
 	}
 
-	// Reset the RNG
-	this->rng.setSeed(hash_seed);
-
-
 	std::vector<double> qpos(m_->nq);
 	for (size_t i = 0; i < qpos.size(); i++) {
 		qpos[i] = init_qpos_[i] + this->rng.getDouble(-reset_noise_scale_, reset_noise_scale_);
@@ -26,22 +20,18 @@ void MujocoAntWrapper::reset(size_t seed, Learn::LearningMode mode, uint16_t ite
 	for (size_t i = 0; i < qvel.size(); i++) {
 		qvel[i] = init_qvel_[i] + this->rng.getDouble(0.0, reset_noise_scale_);
 	}
-	mj_resetData(m_, d_);
-	set_state(qpos, qvel);
-	this->computeState();
-	this->nbActionsExecuted = 0;
-	this->totalReward = 0.0;
+	reset_episode(qpos, qvel);
 }
 
-void MujocoAntWrapper::doActions(std::vector<double> actionsID)
+void MujocoAntWrapper::step(const ActionView& actionsID)
 {
 	auto x_pos_before = d_->qpos[0];
 	do_simulation(actionsID, frame_skip_);
 	auto x_pos_after = d_->qpos[0];
-	auto x_vel = (x_pos_after - x_pos_before) / m_->opt.timestep;
+	auto x_vel = (x_pos_after - x_pos_before) / dt();
 	auto forward_reward = x_vel;
 	auto rewards = forward_reward + healthy_reward();
-	auto ctrl_cost = control_cost(actionsID);
+	auto ctrl_cost = control_cost(control_cost_weight_, actionsID);
 	auto costs = ctrl_cost;
 	if (use_contact_forces_) {
 		costs += contact_cost();
@@ -53,12 +43,7 @@ void MujocoAntWrapper::doActions(std::vector<double> actionsID)
 	// Incremente the reward.
 	this->totalReward += reward;
 
-	this->nbActionsExecuted = 0;
-}
-
-bool MujocoAntWrapper::isCopyable() const
-{
-	return true;
+	this->nbActionsExecuted++;
 }
 
 Learn::LearningEnvironment* MujocoAntWrapper::clone() const
@@ -66,11 +51,6 @@ Learn::LearningEnvironment* MujocoAntWrapper::clone() const
 	return new MujocoAntWrapper(*this);
 }
 
-double MujocoAntWrapper::getScore() const
-{
-	return totalReward;
-}
-
 bool MujocoAntWrapper::isTerminal() const
 {
 	return (terminate_when_unhealthy_ && !is_healthy());
@@ -81,27 +61,12 @@ double MujocoAntWrapper::healthy_reward() {
 			healthy_reward_;
 }
 
-double MujocoAntWrapper::control_cost(std::vector<double>& action) {
-	double cost = 0;
-	for (auto& a : action) cost += a * a;
-	return control_cost_weight_ * cost;
-}
-
-std::vector<double> MujocoAntWrapper::contact_forces() {
-	std::vector<double> forces;
-	std::copy_n(d_->cfrc_ext, m_->nbody * 6, back_inserter(forces));
-	for (auto& f : forces) {
-		f = std::max(contact_force_range_[0],
-						std::min(f, contact_force_range_[1]));
-	}
-	return forces;
-}
-
 double MujocoAntWrapper::contact_cost() {
-	auto forces = contact_forces();
-	double cost = 0;
-	for (auto& f : forces) cost += f * f;
-	return contact_cost_weight_ * cost;
+	ensure_post_constraint();
+
+	// Clamp and reduce in a single pass, without storing the clamped forces.
+	return contact_cost_weight_ * RewardKernels::clampedSumSquares(d_->cfrc_ext,
+				m_->nbody * 6, contact_force_range_[0], contact_force_range_[1]);
 }
 
 bool MujocoAntWrapper::is_healthy() const{
@@ -112,48 +77,3 @@ bool MujocoAntWrapper::is_healthy() const{
 	return (d_->qpos[2] >= healthy_z_range_[0] &&
 			d_->qpos[2] <= healthy_z_range_[1]);
 }
-
-std::string MujocoAntWrapper::ExpandEnvVars(const std::string &str) {
-	std::string result;
-	size_t pos = 0;
-
-	while (pos < str.length()) {
-		if (str[pos] == '$') {
-			size_t start = pos + 1;
-			size_t end = start;
-
-			// Handle ${VAR} format
-			if (start < str.length() && str[start] == '{') {
-				end = str.find('}', start);
-				if (end != std::string::npos) {
-					std::string varName =
-						str.substr(start + 1, end - start - 1);
-					const char *varValue = getenv(varName.c_str());
-					if (varValue) {
-						result += varValue;
-					}
-					pos = end + 1;
-					continue;
-				}
-			}
-
-			// Handle $VAR format
-			while (end < str.length() &&
-				(isalnum(str[end]) || str[end] == '_')) {
-				++end;
-			}
-			std::string varName = str.substr(start, end - start);
-			const char *varValue = getenv(varName.c_str());
-			if (varValue) {
-				result += varValue;
-			}
-			pos = end;
-		} else {
-			result += str[pos];
-			++pos;
-		}
-	}
-	return result;
-}
-
-
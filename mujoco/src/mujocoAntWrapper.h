@@ -5,26 +5,23 @@
 #include "mujocoWrapper.h"
 
 /**
-* \brief Inverted pendulum LearningEnvironment.
+* \brief Ant LearningEnvironment.
 *
-* The code of the class is adapted from Florian Arrestier's code released
-* under CECILL-C License.
-* Link: https://github.com/preesm/preesm-apps/tree/master/org.ietr.preesm.reinforcement_learning
+* A four-legged creature rewarded for walking forward along x. Unlike the
+* Gymnasium environment, the observation contains the full qpos and qvel
+* (29 values).
 */
 class MujocoAntWrapper : public MujocoWrapper
 {
 protected:
 
-	/// Randomness control
-	Mutator::RNG rng;
-
-	/// Total reward accumulated since the last reset
-	double totalReward = 0.0;
-
-	/// Number of actions since the last reset
-	uint64_t nbActionsExecuted = 0;
-
-	const std::string xmlFile;
+	/// Construct the environment from its loaded model.
+	MujocoAntWrapper(std::string actFunc, std::shared_ptr<MujocoEnvPool> pool) :
+		MujocoWrapper(actFunc, pool, pool->getModel()->nq + pool->getModel()->nv)
+		{
+			healthy_z_range_ = {0.2, 1.0};
+			contact_force_range_ = {-1.0, 1.0};
+		};
 
 public:
 
@@ -36,109 +33,63 @@ public:
     bool terminate_when_unhealthy_ = true;
     std::vector<double> healthy_z_range_;
     std::vector<double> contact_force_range_;
-    double reset_noise_scale_ = 0.1;
     bool exclude_current_positions_from_observation_ = false;
 
 
 	/**
 	* \brief Default constructor.
 	*
-	* Attributes angle and velocity are set to 0.0 by default.
+	* \param[in] actFunc activation function applied to the actions.
+	* \param[in] pXmlFile path to the model xml file.
 	*/
 	MujocoAntWrapper(std::string actFunc, const char *pXmlFile) :
-		MujocoWrapper(8, 29, actFunc), xmlFile{pXmlFile} 
-		{
-			model_path_ = ExpandEnvVars(xmlFile);
-			healthy_z_range_ = {0.2, 1.0};
-			contact_force_range_ = {-1.0, 1.0};
-			initialize_simulation();
-
-		};
+		MujocoAntWrapper(actFunc, load_model(pXmlFile)) {};
 
     /**
-    * \brief Copy constructor for the armLearnWrapper.
-    */ 
-    MujocoAntWrapper(const MujocoAntWrapper &other) : MujocoWrapper(other)
-	{   
-		model_path_ = ExpandEnvVars(other.xmlFile);
-		healthy_z_range_ = {0.2, 1.0};
-		contact_force_range_ = {-1.0, 1.0};
-		initialize_simulation();
-    }
-
-    ~MujocoAntWrapper() {
-        // Free visualization storage
-        //mjv_freeScene(&scn_);
-        //mjr_freeContext(&con_);
-
-        // Free MuJoCo model and data
-        mj_deleteData(d_);
-        mj_deleteModel(m_);
-
-        // Terminate GLFW (crashes with Linux NVidia drivers)
-#if defined(__APPLE__) || defined(_WIN32)
-        glfwTerminate();
-#endif
+    * \brief Copy constructor for the MujocoAntWrapper.
+    *
+    * The model is not loaded again: the copy shares it with the other
+    * environment and only gets a copy of its mjData.
+    */
+    MujocoAntWrapper(const MujocoAntWrapper &other) : MujocoWrapper(other),
+		control_cost_weight_{other.control_cost_weight_},
+		use_contact_forces_{other.use_contact_forces_},
+		contact_cost_weight_{other.contact_cost_weight_},
+		healthy_reward_{other.healthy_reward_},
+		terminate_when_unhealthy_{other.terminate_when_unhealthy_},
+		healthy_z_range_{other.healthy_z_range_},
+		contact_force_range_{other.contact_force_range_},
+		exclude_current_positions_from_observation_{other.exclude_current_positions_from_observation_}
+	{
     }
 
 	/// Inherited via LearningEnvironment
 	virtual void reset(size_t seed = 0, Learn::LearningMode mode = Learn::LearningMode::TRAINING,
 					   uint16_t iterationNumber = 0, uint64_t generationNumber = 0) override;
 
+	/// Inherited via MujocoWrapper
+	virtual void step(const ActionView& actions) override;
 
 	/// Inherited via LearningEnvironment
-	virtual void doActions(std::vector<double> actionsID) override;
-
-	/// Inherited via LearningEnvironment
-	virtual bool isCopyable() const override;
-
-	/// Inherited via LearningEnvironment
-	virtual LearningEnvironment* clone() const;
+	virtual LearningEnvironment* clone() const override;
 
 	/**
-	* \brief Get a score for the pendulum stabilization.
+	* \brief Is the ant unhealthy.
 	*
-	* The score returned at any time can either be positive or negative.
+	* The ant is unhealthy if its state is not finite or if its torso is out of
+	* healthy_z_range_.
 	*
-	* A positive score is returned if the pendulum has been stabilized, that is,
-	* the isTerminal() method returns true.
-	* In such a case, the returned score will be $10 / ln(nbActionExecuted)$
-	* such that shorter convergence time leads to higher scores.
-	*
-	* A negative score is returned if the pendulum has not been stabilized
-	* (yet).
-	* In such a case, the returned score simply is the average reward since
-	* the last reset.
-	*
-	* \return a double value corresponding to the score.
-	*/
-	virtual double getScore() const override;
-
-	/**
-	* \brief Is the pendulum considered stabilized.
-	*
-	* If the mean reward over the recent rewardHistory is lower than a fixed
-	* threshold, then the pendulum is considered to be stable in the upward
-	* position and the learningAgent has succeded in stabilizing it.
-	*
-	* \return true if the pendulum has been stabilized, false otherwise.
+	* \return true if the episode is over.
 	*/
 	virtual bool isTerminal() const override;
 
 
     double healthy_reward();
 
-    double control_cost(std::vector<double>& action);
-
-    std::vector<double> contact_forces();
-
     double contact_cost();
 
     bool is_healthy() const;
 
-	std::string ExpandEnvVars(const std::string &str);
-
-
 };
 
-#endif // !MUJOCOANTWRAPPER_H
\ No newline at end of file
+#endif // !MUJOCOANTWRAPPER_H
@@ -0,0 +1,75 @@
+#include <stdio.h>
+
+#include "mujocoEnvPool.h"
+#include "mujocoModelCache.h"
+
+MujocoEnvPool::MujocoEnvPool(const std::string& modelPath, size_t nbInstances)
+{
+	// Load the compiled model, or compile it from the xml
+	char error[1000] = "Could not load binary model";
+	model = loadModelWithCache(modelPath, error, 1000);
+	if (!model) {
+		char formattedError[1100];
+		sprintf(formattedError, "Load model error: %s", error);
+		mju_error(formattedError);
+	}
+
+	reserve(nbInstances);
+}
+
+MujocoEnvPool::~MujocoEnvPool()
+{
+	for (mjData* data : allData) {
+		mj_deleteData(data);
+	}
+	mj_deleteModel(model);
+}
+
+const mjModel* MujocoEnvPool::getModel() const
+{
+	return model;
+}
+
+void MujocoEnvPool::reserve(size_t nbInstances)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	while (allData.size() < nbInstances) {
+		mjData* data = mj_makeData(model);
+		allData.push_back(data);
+		freeData.push_back(data);
+	}
+}
+
+mjData* MujocoEnvPool::acquireData(const mjData* source)
+{
+	mjData* data = NULL;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (freeData.empty()) {
+			data = mj_makeData(model);
+			allData.push_back(data);
+		}
+		else {
+			data = freeData.back();
+			freeData.pop_back();
+		}
+	}
+
+	// Copy outside of the lock, the arena is not involved anymore.
+	if (source != NULL) {
+		mj_copyData(data, model, source);
+	}
+	else {
+		mj_resetData(model, data);
+	}
+	return data;
+}
+
+void MujocoEnvPool::releaseData(mjData* data)
+{
+	if (data == NULL) {
+		return;
+	}
+	std::lock_guard<std::mutex> lock(mutex);
+	freeData.push_back(data);
+}
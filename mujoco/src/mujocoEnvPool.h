@@ -0,0 +1,69 @@
+#ifndef MUJOCOENVPOOL_H
+#define MUJOCOENVPOOL_H
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <mujoco.h>
+
+/**
+* \brief Pool of MuJoCo simulation instances sharing a single model.
+*
+* The mjModel is loaded once and is never modified afterwards, so all the
+* environments cloned from the same MujocoWrapper share it by reference.
+* Each environment still needs its own mjData, which is taken from an arena
+* of instances preallocated by the pool, and given back on destruction.
+*/
+class MujocoEnvPool
+{
+protected:
+	/// Model shared by all the instances of the pool.
+	mjModel* model = NULL;
+
+	/// All the mjData allocated by the pool, in use or not.
+	std::vector<mjData*> allData;
+
+	/// mjData currently available for new environments.
+	std::vector<mjData*> freeData;
+
+	/// Clones may be created and destroyed from several threads.
+	std::mutex mutex;
+
+public:
+	/**
+	* \brief Load the model and preallocate nbInstances mjData.
+	*
+	* \param[in] modelPath absolute path to the model xml file.
+	* \param[in] nbInstances number of mjData allocated in the arena.
+	*/
+	MujocoEnvPool(const std::string& modelPath, size_t nbInstances = 1);
+
+	/// The pool owns its model and data, it can not be copied.
+	MujocoEnvPool(const MujocoEnvPool& other) = delete;
+
+	/// Free the model and all the mjData of the arena.
+	~MujocoEnvPool();
+
+	/// Get the model shared by all the instances of the pool.
+	const mjModel* getModel() const;
+
+	/// Make sure at least nbInstances mjData are allocated in the arena.
+	void reserve(size_t nbInstances);
+
+	/**
+	* \brief Take a mjData from the arena.
+	*
+	* The arena grows if no free mjData is left.
+	*
+	* \param[in] source if not NULL, its content is copied in the returned
+	* mjData with mj_copyData. Otherwise, the returned mjData is reset.
+	* \return a mjData to give back with releaseData().
+	*/
+	mjData* acquireData(const mjData* source = NULL);
+
+	/// Give back a mjData taken with acquireData().
+	void releaseData(mjData* data);
+};
+
+#endif // !MUJOCOENVPOOL_H
@@ -0,0 +1,58 @@
+#include <algorithm>
+
+#include "mujocoHalfCheetahWrapper.h"
+
+void MujocoHalfCheetahWrapper::reset(size_t seed, Learn::LearningMode mode, uint16_t iterationNumber, uint64_t generationNumber)
+{
+	reset_rng(seed, mode);
+	if (restore_initial_state()) {
+		return;
+	}
+
+	std::vector<double> qpos(m_->nq);
+	for (size_t i = 0; i < qpos.size(); i++) {
+		qpos[i] = init_qpos_[i] + this->rng.getDouble(-reset_noise_scale_, reset_noise_scale_);
+	}
+	std::vector<double> qvel(m_->nv);
+	for (size_t i = 0; i < qvel.size(); i++) {
+		qvel[i] = init_qvel_[i] + reset_noise_scale_ * rng_normal();
+	}
+	reset_episode(qpos, qvel);
+}
+
+void MujocoHalfCheetahWrapper::step(const ActionView& actionsID)
+{
+	auto x_pos_before = d_->qpos[0];
+	do_simulation(actionsID, frame_skip_);
+	auto x_pos_after = d_->qpos[0];
+	auto x_vel = (x_pos_after - x_pos_before) / dt();
+
+	auto forward_reward = forward_reward_weight_ * x_vel;
+	auto ctrl_cost = control_cost(control_cost_weight_, actionsID);
+	auto reward = forward_reward - ctrl_cost;
+
+	this->computeState();
+
+	// Incremente the reward.
+	this->totalReward += reward;
+
+	this->nbActionsExecuted++;
+}
+
+Learn::LearningEnvironment* MujocoHalfCheetahWrapper::clone() const
+{
+	return new MujocoHalfCheetahWrapper(*this);
+}
+
+bool MujocoHalfCheetahWrapper::isTerminal() const
+{
+	return false;
+}
+
+void MujocoHalfCheetahWrapper::computeState()
+{
+	// The x position is excluded from the observation.
+	std::copy(d_->qpos + 1, d_->qpos + m_->nq, stateData_);
+	std::copy(d_->qvel, d_->qvel + m_->nv, stateData_ + m_->nq - 1);
+	state_updated();
+}
@@ -0,0 +1,61 @@
+#ifndef MUJOCOHALFCHEETAHWRAPPER_H
+#define MUJOCOHALFCHEETAHWRAPPER_H
+
+#include <gegelati.h>
+#include "mujocoWrapper.h"
+
+/**
+* \brief HalfCheetah LearningEnvironment.
+*
+* A 2D cat-like robot rewarded for running forward along x. The episode
+* never terminates before the maximum number of actions.
+*
+* The observation is qpos without the x position, followed by qvel
+* (17 values).
+*/
+class MujocoHalfCheetahWrapper : public MujocoWrapper
+{
+protected:
+
+	/// Construct the environment from its loaded model.
+	MujocoHalfCheetahWrapper(std::string actFunc, std::shared_ptr<MujocoEnvPool> pool) :
+		MujocoWrapper(actFunc, pool, pool->getModel()->nq - 1 + pool->getModel()->nv) {};
+
+public:
+
+    // Parameters
+    double forward_reward_weight_ = 1.0;
+    double control_cost_weight_ = 0.1;
+
+	/**
+	* \brief Default constructor.
+	*
+	* \param[in] actFunc activation function applied to the actions.
+	* \param[in] pXmlFile path to the model xml file.
+	*/
+	MujocoHalfCheetahWrapper(std::string actFunc, const char *pXmlFile) :
+		MujocoHalfCheetahWrapper(actFunc, load_model(pXmlFile)) {};
+
+	/// Copy constructor, the model is shared with the other environment.
+	MujocoHalfCheetahWrapper(const MujocoHalfCheetahWrapper &other) : MujocoWrapper(other),
+		forward_reward_weight_{other.forward_reward_weight_},
+		control_cost_weight_{other.control_cost_weight_} {};
+
+	/// Inherited via LearningEnvironment
+	virtual void reset(size_t seed = 0, Learn::LearningMode mode = Learn::LearningMode::TRAINING,
+					   uint16_t iterationNumber = 0, uint64_t generationNumber = 0) override;
+
+	/// Inherited via MujocoWrapper
+	virtual void step(const ActionView& actions) override;
+
+	/// Inherited via LearningEnvironment
+	virtual LearningEnvironment* clone() const override;
+
+	/// The HalfCheetah never falls: always false.
+	virtual bool isTerminal() const override;
+
+	/// Inherited via MujocoWrapper
+	virtual void computeState() override;
+};
+
+#endif // !MUJOCOHALFCHEETAHWRAPPER_H
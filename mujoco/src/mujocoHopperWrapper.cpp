@@ -0,0 +1,78 @@
+#include <algorithm>
+
+#include "mujocoHopperWrapper.h"
+
+void MujocoHopperWrapper::reset(size_t seed, Learn::LearningMode mode, uint16_t iterationNumber, uint64_t generationNumber)
+{
+	reset_rng(seed, mode);
+	if (restore_initial_state()) {
+		return;
+	}
+
+	std::vector<double> qpos(m_->nq);
+	for (size_t i = 0; i < qpos.size(); i++) {
+		qpos[i] = init_qpos_[i] + this->rng.getDouble(-reset_noise_scale_, reset_noise_scale_);
+	}
+	std::vector<double> qvel(m_->nv);
+	for (size_t i = 0; i < qvel.size(); i++) {
+		qvel[i] = init_qvel_[i] + this->rng.getDouble(-reset_noise_scale_, reset_noise_scale_);
+	}
+	reset_episode(qpos, qvel);
+}
+
+void MujocoHopperWrapper::step(const ActionView& actionsID)
+{
+	auto x_pos_before = d_->qpos[0];
+	do_simulation(actionsID, frame_skip_);
+	auto x_pos_after = d_->qpos[0];
+	auto x_vel = (x_pos_after - x_pos_before) / dt();
+
+	auto forward_reward = forward_reward_weight_ * x_vel;
+	auto healthy_reward = static_cast<double>(is_healthy() || terminate_when_unhealthy_) * healthy_reward_;
+	auto ctrl_cost = control_cost(control_cost_weight_, actionsID);
+	auto reward = forward_reward + healthy_reward - ctrl_cost;
+
+	this->computeState();
+
+	// Incremente the reward.
+	this->totalReward += reward;
+
+	this->nbActionsExecuted++;
+}
+
+Learn::LearningEnvironment* MujocoHopperWrapper::clone() const
+{
+	return new MujocoHopperWrapper(*this);
+}
+
+bool MujocoHopperWrapper::isTerminal() const
+{
+	return (terminate_when_unhealthy_ && !is_healthy());
+}
+
+void MujocoHopperWrapper::computeState()
+{
+	// The x position is excluded from the observation.
+	std::copy(d_->qpos + 1, d_->qpos + m_->nq, stateData_);
+	double* qvel = stateData_ + m_->nq - 1;
+	for (int i = 0; i < m_->nv; i++) {
+		qvel[i] = std::max(-10.0, std::min(d_->qvel[i], 10.0));
+	}
+	state_updated();
+}
+
+bool MujocoHopperWrapper::is_healthy() const
+{
+	double z = d_->qpos[1];
+	double angle = d_->qpos[2];
+
+	for (int i = 2; i < m_->nq; i++) {
+		if (!(healthy_state_range_[0] < d_->qpos[i] && d_->qpos[i] < healthy_state_range_[1])) return false;
+	}
+	for (int i = 0; i < m_->nv; i++) {
+		if (!(healthy_state_range_[0] < d_->qvel[i] && d_->qvel[i] < healthy_state_range_[1])) return false;
+	}
+
+	return (healthy_z_range_[0] < z && z < healthy_z_range_[1] &&
+			healthy_angle_range_[0] < angle && angle < healthy_angle_range_[1]);
+}
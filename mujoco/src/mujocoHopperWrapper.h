@@ -0,0 +1,84 @@
+#ifndef MUJOCOHOPPERWRAPPER_H
+#define MUJOCOHOPPERWRAPPER_H
+
+#include <limits>
+
+#include <gegelati.h>
+#include "mujocoWrapper.h"
+
+/**
+* \brief Hopper LearningEnvironment.
+*
+* A 2D one-legged robot rewarded for hopping forward along x.
+*
+* The observation is qpos without the x position, followed by qvel clipped
+* in [-10, 10] (11 values).
+*/
+class MujocoHopperWrapper : public MujocoWrapper
+{
+protected:
+
+	/// Construct the environment from its loaded model.
+	MujocoHopperWrapper(std::string actFunc, std::shared_ptr<MujocoEnvPool> pool) :
+		MujocoWrapper(actFunc, pool, pool->getModel()->nq - 1 + pool->getModel()->nv)
+		{
+			reset_noise_scale_ = 5e-3;
+		};
+
+public:
+
+    // Parameters
+    double forward_reward_weight_ = 1.0;
+    double control_cost_weight_ = 1e-3;
+    double healthy_reward_ = 1.0;
+    bool terminate_when_unhealthy_ = true;
+    std::vector<double> healthy_state_range_ = {-100.0, 100.0};
+    std::vector<double> healthy_z_range_ = {0.7, std::numeric_limits<double>::infinity()};
+    std::vector<double> healthy_angle_range_ = {-0.2, 0.2};
+
+	/**
+	* \brief Default constructor.
+	*
+	* \param[in] actFunc activation function applied to the actions.
+	* \param[in] pXmlFile path to the model xml file.
+	*/
+	MujocoHopperWrapper(std::string actFunc, const char *pXmlFile) :
+		MujocoHopperWrapper(actFunc, load_model(pXmlFile)) {};
+
+	/// Copy constructor, the model is shared with the other environment.
+	MujocoHopperWrapper(const MujocoHopperWrapper &other) : MujocoWrapper(other),
+		forward_reward_weight_{other.forward_reward_weight_},
+		control_cost_weight_{other.control_cost_weight_},
+		healthy_reward_{other.healthy_reward_},
+		terminate_when_unhealthy_{other.terminate_when_unhealthy_},
+		healthy_state_range_{other.healthy_state_range_},
+		healthy_z_range_{other.healthy_z_range_},
+		healthy_angle_range_{other.healthy_angle_range_} {};
+
+	/// Inherited via LearningEnvironment
+	virtual void reset(size_t seed = 0, Learn::LearningMode mode = Learn::LearningMode::TRAINING,
+					   uint16_t iterationNumber = 0, uint64_t generationNumber = 0) override;
+
+	/// Inherited via MujocoWrapper
+	virtual void step(const ActionView& actions) override;
+
+	/// Inherited via LearningEnvironment
+	virtual LearningEnvironment* clone() const override;
+
+	/// The episode is over when the hopper is unhealthy.
+	virtual bool isTerminal() const override;
+
+	/// Inherited via MujocoWrapper
+	virtual void computeState() override;
+
+	/**
+	* \brief Is the hopper standing.
+	*
+	* The hopper is healthy if its state (without x and z) is in
+	* healthy_state_range_, its height in healthy_z_range_ and the angle of its
+	* torso in healthy_angle_range_.
+	*/
+	bool is_healthy() const;
+};
+
+#endif // !MUJOCOHOPPERWRAPPER_H
@@ -0,0 +1,71 @@
+#include <algorithm>
+
+#include "mujocoHumanoidWrapper.h"
+
+void MujocoHumanoidWrapper::reset(size_t seed, Learn::LearningMode mode, uint16_t iterationNumber, uint64_t generationNumber)
+{
+	reset_rng(seed, mode);
+	if (restore_initial_state()) {
+		return;
+	}
+
+	std::vector<double> qpos(m_->nq);
+	for (size_t i = 0; i < qpos.size(); i++) {
+		qpos[i] = init_qpos_[i] + this->rng.getDouble(-reset_noise_scale_, reset_noise_scale_);
+	}
+	std::vector<double> qvel(m_->nv);
+	for (size_t i = 0; i < qvel.size(); i++) {
+		qvel[i] = init_qvel_[i] + this->rng.getDouble(-reset_noise_scale_, reset_noise_scale_);
+	}
+	reset_episode(qpos, qvel);
+}
+
+void MujocoHumanoidWrapper::step(const ActionView& actionsID)
+{
+	auto x_pos_before = mass_center_x();
+	do_simulation(actionsID, frame_skip_);
+	auto x_pos_after = mass_center_x();
+	auto x_vel = (x_pos_after - x_pos_before) / dt();
+
+	auto forward_reward = forward_reward_weight_ * x_vel;
+	auto healthy_reward = static_cast<double>(is_healthy() || terminate_when_unhealthy_) * healthy_reward_;
+	auto ctrl_cost = control_cost(control_cost_weight_, actionsID);
+	auto reward = forward_reward + healthy_reward - ctrl_cost;
+
+	this->computeState();
+
+	// Incremente the reward.
+	this->totalReward += reward;
+
+	this->nbActionsExecuted++;
+}
+
+Learn::LearningEnvironment* MujocoHumanoidWrapper::clone() const
+{
+	return new MujocoHumanoidWrapper(*this);
+}
+
+bool MujocoHumanoidWrapper::isTerminal() const
+{
+	return (terminate_when_unhealthy_ && !is_healthy());
+}
+
+void MujocoHumanoidWrapper::computeState()
+{
+	// cfrc_ext is only computed by the post-constraint pass.
+	ensure_post_constraint();
+
+	double* state = stateData_;
+	state = std::copy(d_->qpos + 2, d_->qpos + m_->nq, state);
+	state = std::copy(d_->qvel, d_->qvel + m_->nv, state);
+	state = std::copy(d_->cinert, d_->cinert + m_->nbody * 10, state);
+	state = std::copy(d_->cvel, d_->cvel + m_->nbody * 6, state);
+	state = std::copy(d_->qfrc_actuator, d_->qfrc_actuator + m_->nv, state);
+	std::copy(d_->cfrc_ext, d_->cfrc_ext + m_->nbody * 6, state);
+	state_updated();
+}
+
+bool MujocoHumanoidWrapper::is_healthy() const
+{
+	return (healthy_z_range_[0] < d_->qpos[2] && d_->qpos[2] < healthy_z_range_[1]);
+}
@@ -0,0 +1,81 @@
+#ifndef MUJOCOHUMANOIDWRAPPER_H
+#define MUJOCOHUMANOIDWRAPPER_H
+
+#include <gegelati.h>
+#include "mujocoWrapper.h"
+
+/**
+* \brief Humanoid LearningEnvironment.
+*
+* A 3D bipedal robot rewarded for walking forward along x, measured on its
+* center of mass.
+*
+* The observation is qpos without the x and y positions, qvel, the inertia
+* (cinert) and velocity (cvel) of the bodies, the actuator forces
+* (qfrc_actuator) and the external forces on the bodies (cfrc_ext)
+* (376 values).
+*/
+class MujocoHumanoidWrapper : public MujocoWrapper
+{
+protected:
+
+	/// Number of variables in the observation of a model.
+	static uint64_t observation_size(const mjModel* m)
+	{
+		return (m->nq - 2) + m->nv + m->nbody * 10 + m->nbody * 6 + m->nv + m->nbody * 6;
+	}
+
+	/// Construct the environment from its loaded model.
+	MujocoHumanoidWrapper(std::string actFunc, std::shared_ptr<MujocoEnvPool> pool) :
+		MujocoWrapper(actFunc, pool, observation_size(pool->getModel()))
+		{
+			reset_noise_scale_ = 1e-2;
+		};
+
+public:
+
+    // Parameters
+    double forward_reward_weight_ = 1.25;
+    double control_cost_weight_ = 0.1;
+    double healthy_reward_ = 5.0;
+    bool terminate_when_unhealthy_ = true;
+    std::vector<double> healthy_z_range_ = {1.0, 2.0};
+
+	/**
+	* \brief Default constructor.
+	*
+	* \param[in] actFunc activation function applied to the actions.
+	* \param[in] pXmlFile path to the model xml file.
+	*/
+	MujocoHumanoidWrapper(std::string actFunc, const char *pXmlFile) :
+		MujocoHumanoidWrapper(actFunc, load_model(pXmlFile)) {};
+
+	/// Copy constructor, the model is shared with the other environment.
+	MujocoHumanoidWrapper(const MujocoHumanoidWrapper &other) : MujocoWrapper(other),
+		forward_reward_weight_{other.forward_reward_weight_},
+		control_cost_weight_{other.control_cost_weight_},
+		healthy_reward_{other.healthy_reward_},
+		terminate_when_unhealthy_{other.terminate_when_unhealthy_},
+		healthy_z_range_{other.healthy_z_range_} {};
+
+	/// Inherited via LearningEnvironment
+	virtual void reset(size_t seed = 0, Learn::LearningMode mode = Learn::LearningMode::TRAINING,
+					   uint16_t iterationNumber = 0, uint64_t generationNumber = 0) override;
+
+	/// Inherited via MujocoWrapper
+	virtual void step(const ActionView& actions) override;
+
+	/// Inherited via LearningEnvironment
+	virtual LearningEnvironment* clone() const override;
+
+	/// The episode is over when the humanoid is unhealthy.
+	virtual bool isTerminal() const override;
+
+	/// Inherited via MujocoWrapper
+	virtual void computeState() override;
+
+	/// Is the height of the torso in healthy_z_range_.
+	bool is_healthy() const;
+};
+
+#endif // !MUJOCOHUMANOIDWRAPPER_H
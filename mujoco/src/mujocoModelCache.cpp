@@ -0,0 +1,198 @@
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+#include "fnv1a.h"
+#include "mujocoModelCache.h"
+
+/// Read the whole content of a file.
+static bool readFile(const std::string& path, std::string& content)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+	content.assign((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	return true;
+}
+
+/// Path of a file referenced by a model, relative to the given folder unless
+/// absolute.
+static std::string resolveModelPath(const std::string& folder, const std::string& file)
+{
+	std::filesystem::path path(file);
+	if (path.is_absolute() || folder.empty()) {
+		return path.string();
+	}
+	return (std::filesystem::path(folder) / path).string();
+}
+
+/// Files referenced by an xml model and by the xml files it includes.
+struct ModelFiles
+{
+	/// Folder of the top-level xml file.
+	std::string modelDir;
+
+	/// Already hashed xml files, to stop on recursive includes.
+	std::set<std::string> xmlFiles;
+
+	/// Attributes of the <compiler> elements.
+	std::map<std::string, std::string> compiler;
+
+	/// Element and file of each asset, in the order of the xml files.
+	std::vector<std::pair<std::string, std::string>> assets;
+};
+
+/**
+* Hash an xml file, then the files it includes, in the order of the
+* <include> elements, and collect the asset files of its elements.
+*
+* This is a light scan of the xml, not a parser: elements are matched with
+* regular expressions once the comments are removed.
+*/
+static bool hashXmlFile(const std::string& path, ModelFiles& files, uint64_t& hash)
+{
+	if (!files.xmlFiles.insert(path).second) {
+		return true;
+	}
+	std::string content;
+	if (!readFile(path, content)) {
+		return false;
+	}
+	hash = fnv1a(content.data(), content.size(), hash);
+
+	static const std::regex commentRegex(R"(<!--[\s\S]*?-->)");
+	static const std::regex elementRegex(R"(<\s*(\w+)([^>]*)>)");
+	static const std::regex attributeRegex(R"re((\w+)\s*=\s*(?:"([^"]*)"|'([^']*)'))re");
+	static const std::set<std::string> assetElements = { "mesh", "skin", "hfield", "texture" };
+	static const std::set<std::string> fileAttributes = { "file", "fileright", "fileleft", "fileup", "filedown", "filefront", "fileback" };
+
+	std::string xml = std::regex_replace(content, commentRegex, "");
+	for (std::sregex_iterator element(xml.begin(), xml.end(), elementRegex); element != std::sregex_iterator(); ++element) {
+		std::string name = (*element)[1].str();
+		std::string attributes = (*element)[2].str();
+		for (std::sregex_iterator attribute(attributes.begin(), attributes.end(), attributeRegex); attribute != std::sregex_iterator(); ++attribute) {
+			std::string key = (*attribute)[1].str();
+			std::string value = (*attribute)[2].matched ? (*attribute)[2].str() : (*attribute)[3].str();
+			if (name == "include" && key == "file") {
+				// Included files are relative to the top-level xml file.
+				if (!hashXmlFile(resolveModelPath(files.modelDir, value), files, hash)) {
+					return false;
+				}
+			}
+			else if (name == "compiler") {
+				files.compiler[key] = value;
+			}
+			else if (assetElements.count(name) != 0 && fileAttributes.count(key) != 0) {
+				files.assets.emplace_back(name, value);
+			}
+		}
+	}
+	return true;
+}
+
+std::string getModelCachePath(const std::string& xmlPath)
+{
+	ModelFiles files;
+	files.modelDir = std::filesystem::path(xmlPath).parent_path().string();
+	uint64_t hash = FNV1A_OFFSET_BASIS;
+	if (!hashXmlFile(xmlPath, files, hash)) {
+		return "";
+	}
+
+	// Assets are relative to the meshdir or texturedir of the compiler, which
+	// default to its assetdir, themselves relative to the top-level xml file.
+	std::string assetDir = files.compiler.count("assetdir") ? files.compiler["assetdir"] : "";
+	std::string meshDir = files.compiler.count("meshdir") ? files.compiler["meshdir"] : assetDir;
+	std::string textureDir = files.compiler.count("texturedir") ? files.compiler["texturedir"] : assetDir;
+	for (const auto& asset : files.assets) {
+		std::string folder = resolveModelPath(files.modelDir, (asset.first == "texture") ? textureDir : meshDir);
+		if (!fnv1aFile(resolveModelPath(folder, asset.second), hash)) {
+			return "";
+		}
+	}
+
+	// The binary format depends on the MuJoCo version and on mjtNum.
+	int version = mj_version();
+	hash = fnv1a((const char*)&version, sizeof(version), hash);
+	size_t numSize = sizeof(mjtNum);
+	hash = fnv1a((const char*)&numSize, sizeof(numSize), hash);
+
+	std::stringstream path;
+	path << xmlPath << "." << std::hex << hash << ".mjb";
+	return path.str();
+}
+
+/// Remove the .mjb files of an xml model other than the current one.
+static void removeStaleModelCaches(const std::string& xmlPath, const std::string& cachePath)
+{
+	std::filesystem::path xml(xmlPath);
+	std::string prefix = xml.filename().string() + ".";
+	std::string current = std::filesystem::path(cachePath).filename().string();
+	std::filesystem::path folder = xml.has_parent_path() ? xml.parent_path() : std::filesystem::path(".");
+	std::error_code error;
+	for (const auto& entry : std::filesystem::directory_iterator(folder, error)) {
+		std::string name = entry.path().filename().string();
+		if (name == current || name.size() <= prefix.size() + 4 || name.compare(0, prefix.size(), prefix) != 0 ||
+			name.compare(name.size() - 4, 4, ".mjb") != 0) {
+			continue;
+		}
+		// Only <xml>.<hash>.mjb names, the temporary files of other processes
+		// end with .tmp.
+		std::string hash = name.substr(prefix.size(), name.size() - prefix.size() - 4);
+		if (hash.find_first_not_of("0123456789abcdef") == std::string::npos) {
+			std::filesystem::remove(entry.path(), error);
+		}
+	}
+}
+
+mjModel* loadModelWithCache(const std::string& xmlPath, char* error, int errorSize)
+{
+	std::string cachePath = getModelCachePath(xmlPath);
+
+	// Use the compiled model if it exists.
+	if (!cachePath.empty()) {
+		std::ifstream cacheFile(cachePath, std::ios::binary);
+		if (cacheFile.good()) {
+			cacheFile.close();
+			mjModel* model = mj_loadModel(cachePath.c_str(), NULL);
+			if (model != NULL) {
+				return model;
+			}
+			// Corrupted cache file, it is overwritten below.
+		}
+	}
+
+	mjModel* model = mj_loadXML(xmlPath.c_str(), NULL, error, errorSize);
+	if (model == NULL || cachePath.empty()) {
+		return model;
+	}
+
+	// Save in a file specific to this process, then rename it, so that
+	// processes launched in parallel never read a partially written cache.
+	std::string tmpPath = cachePath + "." + std::to_string(getpid()) + ".tmp";
+	mj_saveModel(model, tmpPath.c_str(), NULL, 0);
+	if (std::rename(tmpPath.c_str(), cachePath.c_str()) != 0) {
+		// Another process may have created the cache in the meantime.
+		std::remove(tmpPath.c_str());
+	}
+	else {
+		// Cache files of former versions of the model are never read again.
+		removeStaleModelCaches(xmlPath, cachePath);
+	}
+
+	return model;
+}
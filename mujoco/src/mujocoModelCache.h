@@ -0,0 +1,40 @@
+#ifndef MUJOCOMODELCACHE_H
+#define MUJOCOMODELCACHE_H
+
+#include <cstdint>
+#include <string>
+
+#include <mujoco.h>
+
+/**
+* \brief Load a MuJoCo model, using a compiled binary (MJB) cache if possible.
+*
+* Compiling the xml of a model is much slower than loading its binary
+* version. On the first load of an xml file, the compiled model is saved in
+* an .mjb file next to it, named after a hash of the content of the xml, of
+* the xml files it includes, of its mesh, skin, height field and texture
+* files, and of the MuJoCo version. Later loads of the same model use
+* mj_loadModel on this file. When one of these files is edited, the hash
+* changes: a new .mjb file is created and those of the former versions of
+* the model are removed.
+*
+* If the cache file can not be read nor written (e.g. read-only directory),
+* the model is simply compiled from the xml.
+*
+* \param[in] xmlPath absolute path to the model xml file.
+* \param[out] error buffer receiving the error message when loading fails.
+* \param[in] errorSize size of the error buffer.
+* \return the loaded model, or NULL if the xml could not be compiled.
+*/
+mjModel* loadModelWithCache(const std::string& xmlPath, char* error, int errorSize);
+
+/**
+* \brief Get the path of the .mjb cache file for an xml model.
+*
+* \param[in] xmlPath path to the model xml file.
+* \return the cache file path, or an empty string if the xml, one of the
+* files it includes or one of its assets can not be read.
+*/
+std::string getModelCachePath(const std::string& xmlPath);
+
+#endif // !MUJOCOMODELCACHE_H
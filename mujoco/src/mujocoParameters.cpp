@@ -0,0 +1,32 @@
+#include <fstream>
+#include <iostream>
+#include <regex>
+#include <sstream>
+
+#include "mujocoParameters.h"
+
+void MujocoParameters::loadFromJson(const char* path)
+{
+	std::ifstream file(path);
+	if (!file) {
+		std::cerr << "Could not open parameter file " << path << std::endl;
+		return;
+	}
+
+	// Remove the comments, so that default values are not read.
+	std::stringstream content;
+	std::string line;
+	while (std::getline(file, line)) {
+		content << line.substr(0, line.find("//")) << "\n";
+	}
+	std::string json = std::regex_replace(content.str(), std::regex(R"(/\*[\s\S]*?\*/)"), "");
+
+	std::smatch match;
+	if (std::regex_search(json, match, std::regex(R"("frameSkip"\s*:\s*(\d+))"))) {
+		frameSkip = std::stoi(match[1]);
+		if (frameSkip < 1) {
+			std::cerr << "Invalid frameSkip " << frameSkip << ", 1 is used." << std::endl;
+			frameSkip = 1;
+		}
+	}
+}
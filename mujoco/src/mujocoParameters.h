@@ -0,0 +1,29 @@
+#ifndef MUJOCOPARAMETERS_H
+#define MUJOCOPARAMETERS_H
+
+#include <string>
+
+/**
+* \brief Parameters of the MuJoCo environments.
+*
+* These parameters are stored in the same json file as the
+* Learn::LearningParameters, but are not known by GEGELATI, so they are
+* read separately.
+*/
+struct MujocoParameters
+{
+	/// Number of simulation steps per action (action repeat).
+	int frameSkip = 1;
+
+	/**
+	* \brief Read the parameters from a json parameter file.
+	*
+	* Parameters absent from the file keep their default value. Commented
+	* lines are ignored.
+	*
+	* \param[in] path path to the json file.
+	*/
+	void loadFromJson(const char* path);
+};
+
+#endif // !MUJOCOPARAMETERS_H
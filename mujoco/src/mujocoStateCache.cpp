@@ -0,0 +1,47 @@
+#include "mujocoStateCache.h"
+
+void MujocoStateSnapshot::capture(const mjModel* m, const mjData* d)
+{
+	if (!data) {
+		data.reset(mj_makeData(m));
+	}
+	mj_copyData(data.get(), m, d);
+}
+
+void MujocoStateSnapshot::restore(const mjModel* m, mjData* d) const
+{
+	if (!data) {
+		mju_error("Restoring an empty state snapshot");
+	}
+	mj_copyData(d, m, data.get());
+}
+
+std::shared_ptr<const MujocoStateSnapshot> MujocoStateCache::find(size_t seed) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = states.find(seed);
+	if (it == states.end()) {
+		return NULL;
+	}
+	return it->second;
+}
+
+void MujocoStateCache::insert(size_t seed, std::shared_ptr<const MujocoStateSnapshot> snapshot)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (capacity == 0 || !states.emplace(seed, snapshot).second) {
+		return;
+	}
+	insertionOrder.push_back(seed);
+	if (insertionOrder.size() > capacity) {
+		states.erase(insertionOrder.front());
+		insertionOrder.pop_front();
+	}
+}
+
+void MujocoStateCache::clear()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	states.clear();
+	insertionOrder.clear();
+}
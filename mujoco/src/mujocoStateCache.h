@@ -0,0 +1,86 @@
+#ifndef MUJOCOSTATECACHE_H
+#define MUJOCOSTATECACHE_H
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <mujoco.h>
+
+/**
+* \brief Snapshot of the state of a MuJoCo simulation.
+*
+* The snapshot is a complete copy of the mjData, made with mj_copyData()
+* after mj_forward(): the physics state and all the quantities derived from
+* it (xpos, cinert, qacc_warmstart, ...). Restoring it gives the exact mjData
+* of a reset without the cache, without running mj_forward() again.
+*
+* The observation computed from this state is stored along, so that
+* restoring a snapshot does not need any computation.
+*/
+struct MujocoStateSnapshot
+{
+	/// Copy of the mjData of the simulation.
+	std::unique_ptr<mjData, void (*)(mjData*)> data{NULL, mj_deleteData};
+
+	/// Observation of the environment in this state.
+	std::vector<double> observation;
+
+	/// Copy d in the snapshot.
+	void capture(const mjModel* m, const mjData* d);
+
+	/// Copy the snapshot in d, derived quantities included.
+	void restore(const mjModel* m, mjData* d) const;
+};
+
+/**
+* \brief Cache of the initial states of the episodes, keyed by reset seed.
+*
+* Resetting an environment draws a noisy initial state and runs mj_forward()
+* on it. All the roots of a generation are evaluated with the same seeds, so
+* the resulting mjData are stored once and copied back by the following
+* resets, which neither draw random numbers nor run mj_forward().
+*
+* The cache is shared by all the clones of an environment, which may be
+* evaluated in parallel. When it is full, the oldest state is dropped.
+*/
+class MujocoStateCache
+{
+protected:
+	/// Maximum number of states kept in the cache.
+	size_t capacity;
+
+	/// Cached states.
+	std::unordered_map<size_t, std::shared_ptr<const MujocoStateSnapshot>> states;
+
+	/// Keys of the cached states, from the oldest to the newest.
+	std::deque<size_t> insertionOrder;
+
+	/// Clones access the cache from several threads.
+	mutable std::mutex mutex;
+
+public:
+	/**
+	* \brief Constructor.
+	*
+	* \param[in] capacity maximum number of states kept in the cache.
+	*/
+	MujocoStateCache(size_t capacity = 1024) : capacity{capacity} {};
+
+	/**
+	* \brief Get the state stored for a seed.
+	*
+	* \return the snapshot, or NULL if the seed is not in the cache.
+	*/
+	std::shared_ptr<const MujocoStateSnapshot> find(size_t seed) const;
+
+	/// Store the state reached for a seed, if it is not already cached.
+	void insert(size_t seed, std::shared_ptr<const MujocoStateSnapshot> snapshot);
+
+	/// Remove all the states, e.g. when the reset parameters change.
+	void clear();
+};
+
+#endif // !MUJOCOSTATECACHE_H
@@ -0,0 +1,35 @@
+#include "mujocoTaskRegistry.h"
+#include "mujocoAntWrapper.h"
+#include "mujocoHalfCheetahWrapper.h"
+#include "mujocoHopperWrapper.h"
+#include "mujocoHumanoidWrapper.h"
+#include "mujocoWalker2dWrapper.h"
+
+/// Register a task whose environment class is constructed from (actFunc, xmlFile).
+template <class T> static MujocoTask makeTask(const std::string& name, const std::string& xmlFile)
+{
+	return MujocoTask{name, xmlFile,
+		[](const std::string& actFunc, const char* xml) -> MujocoWrapper* { return new T(actFunc, xml); }};
+}
+
+const std::vector<MujocoTask>& getMujocoTasks()
+{
+	static const std::vector<MujocoTask> tasks = {
+		makeTask<MujocoAntWrapper>("ant", "mujoco_models/ant.xml"),
+		makeTask<MujocoHalfCheetahWrapper>("halfcheetah", "mujoco_models/half_cheetah.xml"),
+		makeTask<MujocoHopperWrapper>("hopper", "mujoco_models/hopper.xml"),
+		makeTask<MujocoWalker2dWrapper>("walker2d", "mujoco_models/walker2d.xml"),
+		makeTask<MujocoHumanoidWrapper>("humanoid", "mujoco_models/humanoid.xml"),
+	};
+	return tasks;
+}
+
+const MujocoTask* findMujocoTask(const std::string& name)
+{
+	for (const MujocoTask& task : getMujocoTasks()) {
+		if (task.name == name) {
+			return &task;
+		}
+	}
+	return NULL;
+}
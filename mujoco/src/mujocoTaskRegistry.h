@@ -0,0 +1,40 @@
+#ifndef MUJOCOTASKREGISTRY_H
+#define MUJOCOTASKREGISTRY_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "mujocoWrapper.h"
+
+/**
+* \brief Description of a MuJoCo task available in the applications.
+*/
+struct MujocoTask
+{
+	/// Name of the task, used to select it on the command line.
+	std::string name;
+
+	/// Default model xml file, relative to the mujoco directory.
+	std::string defaultXmlFile;
+
+	/**
+	* \brief Create the LearningEnvironment of the task.
+	*
+	* Arguments are the activation function and the path to the xml file.
+	*/
+	std::function<MujocoWrapper*(const std::string&, const char*)> create;
+};
+
+/// Get all the registered tasks: ant, halfcheetah, hopper, walker2d, humanoid.
+const std::vector<MujocoTask>& getMujocoTasks();
+
+/**
+* \brief Get a task by name.
+*
+* \param[in] name the name of the task.
+* \return the task, or NULL if no task has this name.
+*/
+const MujocoTask* findMujocoTask(const std::string& name);
+
+#endif // !MUJOCOTASKREGISTRY_H
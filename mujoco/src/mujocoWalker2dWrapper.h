@@ -0,0 +1,79 @@
+#ifndef MUJOCOWALKER2DWRAPPER_H
+#define MUJOCOWALKER2DWRAPPER_H
+
+#include <gegelati.h>
+#include "mujocoWrapper.h"
+
+/**
+* \brief Walker2d LearningEnvironment.
+*
+* A 2D two-legged robot rewarded for walking forward along x.
+*
+* The observation is qpos without the x position, followed by qvel clipped
+* in [-10, 10] (17 values).
+*/
+class MujocoWalker2dWrapper : public MujocoWrapper
+{
+protected:
+
+	/// Construct the environment from its loaded model.
+	MujocoWalker2dWrapper(std::string actFunc, std::shared_ptr<MujocoEnvPool> pool) :
+		MujocoWrapper(actFunc, pool, pool->getModel()->nq - 1 + pool->getModel()->nv)
+		{
+			reset_noise_scale_ = 5e-3;
+		};
+
+public:
+
+    // Parameters
+    double forward_reward_weight_ = 1.0;
+    double control_cost_weight_ = 1e-3;
+    double healthy_reward_ = 1.0;
+    bool terminate_when_unhealthy_ = true;
+    std::vector<double> healthy_z_range_ = {0.8, 2.0};
+    std::vector<double> healthy_angle_range_ = {-1.0, 1.0};
+
+	/**
+	* \brief Default constructor.
+	*
+	* \param[in] actFunc activation function applied to the actions.
+	* \param[in] pXmlFile path to the model xml file.
+	*/
+	MujocoWalker2dWrapper(std::string actFunc, const char *pXmlFile) :
+		MujocoWalker2dWrapper(actFunc, load_model(pXmlFile)) {};
+
+	/// Copy constructor, the model is shared with the other environment.
+	MujocoWalker2dWrapper(const MujocoWalker2dWrapper &other) : MujocoWrapper(other),
+		forward_reward_weight_{other.forward_reward_weight_},
+		control_cost_weight_{other.control_cost_weight_},
+		healthy_reward_{other.healthy_reward_},
+		terminate_when_unhealthy_{other.terminate_when_unhealthy_},
+		healthy_z_range_{other.healthy_z_range_},
+		healthy_angle_range_{other.healthy_angle_range_} {};
+
+	/// Inherited via LearningEnvironment
+	virtual void reset(size_t seed = 0, Learn::LearningMode mode = Learn::LearningMode::TRAINING,
+					   uint16_t iterationNumber = 0, uint64_t generationNumber = 0) override;
+
+	/// Inherited via MujocoWrapper
+	virtual void step(const ActionView& actions) override;
+
+	/// Inherited via LearningEnvironment
+	virtual LearningEnvironment* clone() const override;
+
+	/// The episode is over when the walker is unhealthy.
+	virtual bool isTerminal() const override;
+
+	/// Inherited via MujocoWrapper
+	virtual void computeState() override;
+
+	/**
+	* \brief Is the walker standing.
+	*
+	* The walker is healthy if its height is in healthy_z_range_ and the angle
+	* of its torso in healthy_angle_range_.
+	*/
+	bool is_healthy() const;
+};
+
+#endif // !MUJOCOWALKER2DWRAPPER_H
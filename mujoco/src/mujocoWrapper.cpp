@@ -1,7 +1,10 @@
 #define _USE_MATH_DEFINES // To get M_PI
 #include <math.h>
+#include <algorithm>
+#include <limits>
 
 #include "mujocoWrapper.h"
+#include "RewardKernels/rewardKernels.h"
 
 
 std::vector<std::reference_wrapper<const Data::DataHandler>> MujocoWrapper::getDataSources()
@@ -12,20 +15,79 @@ std::vector<std::reference_wrapper<const Data::DataHandler>> MujocoWrapper::getD
 }
 
 
-void MujocoWrapper::initialize_simulation() {
-	// Load and compile model
-	char error[1000] = "Could not load binary model";
-	m_ = mj_loadXML(model_path_.c_str(), 0, error, 1000);
-	if (!m_) {
-		char formattedError[256];
-		sprintf(formattedError, "Load model error: %s", error);
-		mju_error(formattedError);
+void MujocoWrapper::cacheStatePointer() {
+	stateData_ = currentState.getRawData();
+}
+
+std::shared_ptr<MujocoEnvPool> MujocoWrapper::load_model(const std::string& xmlFile) {
+	// Load the model once, clones will share it through the pool.
+	return std::make_shared<MujocoEnvPool>(ExpandEnvVars(xmlFile));
+}
+
+void MujocoWrapper::doActions(std::vector<double> actionsID)
+{
+	step(actionsID);
+}
+
+bool MujocoWrapper::isCopyable() const
+{
+	return true;
+}
+
+double MujocoWrapper::getScore() const
+{
+	return totalReward;
+}
+
+void MujocoWrapper::reset_rng(size_t seed, Learn::LearningMode mode)
+{
+	// Create seed from seed and mode
+	size_t hash_seed = Data::Hash<size_t>()(seed) ^ Data::Hash<Learn::LearningMode>()(mode);
+	if(mode == Learn::LearningMode::VALIDATION){
+		hash_seed = 6416846135168433;
 	}
-	// Make data
-	d_ = mj_makeData(m_);
 
-	std::copy_n(d_->qpos, m_->nq, back_inserter(init_qpos_));
-	std::copy_n(d_->qvel, m_->nv, back_inserter(init_qvel_));
+	// Reset the RNG
+	this->rng.setSeed(hash_seed);
+	reset_seed_ = hash_seed;
+}
+
+bool MujocoWrapper::restore_initial_state()
+{
+	std::shared_ptr<const MujocoStateSnapshot> snapshot = state_cache_->find(reset_seed_);
+	if (!snapshot) {
+		return false;
+	}
+	restore_snapshot(*snapshot);
+	this->nbActionsExecuted = 0;
+	this->totalReward = 0.0;
+	return true;
+}
+
+double MujocoWrapper::rng_normal()
+{
+	// Box-Muller transform
+	double u1 = this->rng.getDouble(std::numeric_limits<double>::min(), 1.0);
+	double u2 = this->rng.getDouble(0.0, 1.0);
+	return std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * M_PI * u2);
+}
+
+void MujocoWrapper::reset_episode(std::vector<double>& qpos, std::vector<double>& qvel)
+{
+	mj_resetData(m_, d_);
+	set_state(qpos, qvel);
+	this->computeState();
+	this->nbActionsExecuted = 0;
+	this->totalReward = 0.0;
+
+	// Following resets with the same seed will restore this state.
+	std::shared_ptr<MujocoStateSnapshot> snapshot = std::make_shared<MujocoStateSnapshot>();
+	get_snapshot(*snapshot);
+	state_cache_->insert(reset_seed_, snapshot);
+}
+
+void MujocoWrapper::reserve_instances(size_t nbInstances) {
+	pool_->reserve(nbInstances);
 }
 
 void MujocoWrapper::set_state(std::vector<double>& qpos, std::vector<double>& qvel) {
@@ -37,31 +99,108 @@ void MujocoWrapper::set_state(std::vector<double>& qpos, std::vector<double>& qv
 	for (int i = 0; i < m_->nq; i++) d_->qpos[i] = qpos[i];
 	for (int i = 0; i < m_->nv; i++) d_->qvel[i] = qvel[i];
 	mj_forward(m_, d_);
+	post_constraint_valid_ = false;
+}
+
+void MujocoWrapper::get_snapshot(MujocoStateSnapshot& snapshot) const {
+	snapshot.capture(m_, d_);
+	snapshot.observation.assign(stateData_, stateData_ + obs_size_);
+}
+
+void MujocoWrapper::restore_snapshot(const MujocoStateSnapshot& snapshot) {
+	snapshot.restore(m_, d_);
+	std::copy(snapshot.observation.begin(), snapshot.observation.end(), stateData_);
+	state_updated();
+	// The snapshot was taken after mj_forward(), not mj_rnePostConstraint().
+	post_constraint_valid_ = false;
+}
+
+void MujocoWrapper::state_updated(){
+	currentState.invalidateHash();
 }
 
 void MujocoWrapper::computeState(){
-	int index = 0;
-	for (int i = 0; i < m_->nq; i++) 
-	{
-		currentState.setDataAt(typeid(double), index, d_->qpos[i]);
-		index++;
-	}
-	for (int i = 0; i < m_->nv; i++) 
-	{
-		currentState.setDataAt(typeid(double), index, d_->qvel[i]);
-		index++;
-	}
+	std::copy(d_->qpos, d_->qpos + m_->nq, stateData_);
+	std::copy(d_->qvel, d_->qvel + m_->nv, stateData_ + m_->nq);
+	state_updated();
 }
 
-void MujocoWrapper::do_simulation(std::vector<double>& ctrl, int n_frames) {
-	for (int i = 0; i < m_->nu; i++) {
-		d_->ctrl[i] = ctrl[i];
-	}
+void MujocoWrapper::do_simulation(const ActionView& ctrl, int n_frames) {
+	std::copy(ctrl.begin(), ctrl.begin() + m_->nu, d_->ctrl);
 	for (int i = 0; i < n_frames; i++) {
 		mj_step(m_, d_);
 	}
+	post_constraint_valid_ = false;
+}
+
+void MujocoWrapper::ensure_post_constraint() {
 	// As of MuJoCo 2.0, force - related quantities like cacc are not
 	// computed unless there's a force sensor in the model. See https:
 	// // github.com/openai/gym/issues/1541
-	mj_rnePostConstraint(m_, d_);
+	if (!post_constraint_valid_) {
+		mj_rnePostConstraint(m_, d_);
+		post_constraint_valid_ = true;
+	}
+}
+
+double MujocoWrapper::dt() const {
+	return m_->opt.timestep * frame_skip_;
+}
+
+double MujocoWrapper::control_cost(double weight, const ActionView& action) const {
+	return weight * RewardKernels::sumSquares(action.data, action.size);
+}
+
+double MujocoWrapper::mass_center_x() const {
+	// Body 0 is the world, its mass is 0.
+	double mass = 0.0;
+	double x = 0.0;
+	for (int i = 0; i < m_->nbody; i++) {
+		mass += m_->body_mass[i];
+		x += m_->body_mass[i] * d_->xipos[3 * i];
+	}
+	return x / mass;
+}
+
+std::string MujocoWrapper::ExpandEnvVars(const std::string &str) {
+	std::string result;
+	size_t pos = 0;
+
+	while (pos < str.length()) {
+		if (str[pos] == '$') {
+			size_t start = pos + 1;
+			size_t end = start;
+
+			// Handle ${VAR} format
+			if (start < str.length() && str[start] == '{') {
+				end = str.find('}', start);
+				if (end != std::string::npos) {
+					std::string varName =
+						str.substr(start + 1, end - start - 1);
+					const char *varValue = getenv(varName.c_str());
+					if (varValue) {
+						result += varValue;
+					}
+					pos = end + 1;
+					continue;
+				}
+			}
+
+			// Handle $VAR format
+			while (end < str.length() &&
+				(isalnum(str[end]) || str[end] == '_')) {
+				++end;
+			}
+			std::string varName = str.substr(start, end - start);
+			const char *varValue = getenv(varName.c_str());
+			if (varValue) {
+				result += varValue;
+			}
+			pos = end;
+		} else {
+			result += str[pos];
+			++pos;
+		}
+	}
+	return result;
 }
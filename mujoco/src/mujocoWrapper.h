@@ -1,69 +1,246 @@
 #ifndef MUJOCOWRAPPER_H
 #define MUJOCOWRAPPER_H
 
+#include <memory>
+
 #include <gegelati.h>
 #include <mujoco.h>
 
+#include "typedStateArray.h"
+#include "mujocoEnvPool.h"
+#include "mujocoStateCache.h"
+
 /**
-* \brief Inverted pendulum LearningEnvironment.
+* \brief Non-owning view on a contiguous array of actions.
 *
-* The code of the class is adapted from Florian Arrestier's code released
-* under CECILL-C License.
-* Link: https://github.com/preesm/preesm-apps/tree/master/org.ietr.preesm.reinforcement_learning
+* Lets the step functions of the environments work on the actions without
+* copying them, whether they are stored in a std::vector or in a raw array.
+*/
+struct ActionView
+{
+	const double* data;
+	size_t size;
+
+	ActionView(const double* pData, size_t pSize) : data{pData}, size{pSize} {}
+
+	ActionView(const std::vector<double>& actions) : data{actions.data()}, size{actions.size()} {}
+
+	const double& operator[](size_t i) const { return data[i]; }
+
+	const double* begin() const { return data; }
+
+	const double* end() const { return data + size; }
+};
+
+/**
+* \brief Base class of the LearningEnvironment simulated with MuJoCo.
+*
+* The number of actions is the number of actuators (nu) of the model. Each
+* task derived from this class defines its observation, its reward and its
+* termination, following the Gymnasium (v4) MuJoCo environments.
 */
 class MujocoWrapper : public Learn::LearningEnvironment
 {
 protected:
 
-	Data::PrimitiveTypeArray<double> currentState;
+	TypedStateArray<double> currentState;
 
-public:
+	/// Pointer to the contiguous storage of currentState, for bulk copies.
+	double* stateData_ = NULL;
+
+	/// Get the pointer to the storage of currentState, once per instance.
+	void cacheStatePointer();
+
+	/// Randomness control
+	Mutator::RNG rng;
+
+	/// Total reward accumulated since the last reset
+	double totalReward = 0.0;
+
+	/// Number of actions since the last reset
+	uint64_t nbActionsExecuted = 0;
+
+	/// Seed of the RNG for the current episode, key of its initial state.
+	size_t reset_seed_ = 0;
+
+	/**
+	* \brief Seed the RNG for a new episode.
+	*
+	* All validation episodes use the same seed.
+	*/
+	void reset_rng(size_t seed, Learn::LearningMode mode);
+
+	/**
+	* \brief Restore the initial state of the episode from state_cache_.
+	*
+	* Must be called after reset_rng(). On success, the episode counters are
+	* reset and drawing a new initial state is not needed.
+	*
+	* \return true if the state for reset_seed_ was in the cache.
+	*/
+	bool restore_initial_state();
+
+	/// Draw a number from the standard normal distribution with rng.
+	double rng_normal();
 
+	/**
+	* \brief Reset the simulation to the given state and the episode counters.
+	*
+	* The resulting state is stored in state_cache_ for reset_seed_.
+	*
+	* \param[in] qpos joint positions, of size nq.
+	* \param[in] qvel joint velocities, of size nv.
+	*/
+	void reset_episode(std::vector<double>& qpos, std::vector<double>& qvel);
 
 	/**
-	* \brief Default constructor.
+	* \brief Invalidate the hash of currentState after a bulk write through
+	* stateData_.
+	*/
+	void state_updated();
+
+public:
+
+	/**
+	* \brief Constructor from the model of a task.
 	*
-	* Attributes angle and velocity are set to 0.0 by default.
+	* \param[in] actFunc activation function applied to the actions.
+	* \param[in] pool pool holding the model of the task, see load_model().
+	* \param[in] stateSize number of variables in the observation.
 	*/
-	MujocoWrapper(uint64_t nbActions, uint64_t stateSize, std::string actFunc) :
-		LearningEnvironment(nbActions, 0, false, nbActions, actFunc),
-		currentState{ stateSize }
-	{};
+	MujocoWrapper(std::string actFunc, std::shared_ptr<MujocoEnvPool> pool, uint64_t stateSize) :
+		LearningEnvironment(pool->getModel()->nu, 0, false, pool->getModel()->nu, actFunc),
+		currentState{ stateSize }, pool_{pool}, m_{pool->getModel()},
+		state_cache_{std::make_shared<MujocoStateCache>()}, obs_size_{(int)stateSize}
+	{
+		cacheStatePointer();
+		d_ = pool_->acquireData();
+		init_qpos_.assign(d_->qpos, d_->qpos + m_->nq);
+		init_qvel_.assign(d_->qvel, d_->qvel + m_->nv);
+	};
 
 	/**
 	* \brief Copy constructor for the MujocoWrapper.
 	*
-	* Default copy constructor since all attributes are trivially copyable.
+	* The copy shares the mjModel of the other MujocoWrapper, and gets its own
+	* mjData from the MujocoEnvPool, holding a copy of the other mjData. The
+	* cache of initial states is shared too.
 	*/
 	MujocoWrapper(const MujocoWrapper& other) : LearningEnvironment(other.nbContinuousAction, 0, false, other.nbContinuousAction, other.activationFunction),
-		currentState{other.currentState} {}
-	
+		currentState{other.currentState}, pool_{other.pool_}, m_{other.m_},
+		reset_noise_scale_{other.reset_noise_scale_},
+		init_qpos_{other.init_qpos_}, init_qvel_{other.init_qvel_},
+		state_cache_{other.state_cache_}, frame_skip_{other.frame_skip_}, obs_size_{other.obs_size_},
+		post_constraint_valid_{other.post_constraint_valid_}
+	{
+		cacheStatePointer();
+		d_ = pool_->acquireData(other.d_);
+	}
+
+	/// Give the mjData back to the MujocoEnvPool.
+	virtual ~MujocoWrapper()
+	{
+		pool_->releaseData(d_);
+	}
+
+	/**
+	* \brief Load the model of a task.
+	*
+	* \param[in] xmlFile path to the model xml file, environment variables
+	* ($VAR or ${VAR}) are expanded.
+	* \return a pool to give to the constructor of the task.
+	*/
+	static std::shared_ptr<MujocoEnvPool> load_model(const std::string& xmlFile);
 
 	/// Inherited via LearningEnvironment
 	virtual std::vector<std::reference_wrapper<const Data::DataHandler>> getDataSources() override;
 
+	/// Inherited via LearningEnvironment
+	virtual void doActions(std::vector<double> actionsID) override;
+
+	/// Inherited via LearningEnvironment
+	virtual bool isCopyable() const override;
+
+	/**
+	* \brief Get the total reward accumulated since the last reset.
+	*
+	* \return a double value corresponding to the score.
+	*/
+	virtual double getScore() const override;
+
+	/**
+	* \brief Apply the actions and simulate one step of the environment.
+	*
+	* Unlike doActions(), this function never allocates memory.
+	*
+	* \param[in] actions the control applied to each actuator.
+	*/
+	virtual void step(const ActionView& actions) = 0;
+
 	// MuJoCo data structures
-    mjModel* m_ = NULL;  // MuJoCo model
+    std::shared_ptr<MujocoEnvPool> pool_;  // Shared model and mjData arena
+    const mjModel* m_ = NULL;  // MuJoCo model, shared by all clones
     mjData* d_ = NULL;   // MuJoCo data
-    mjvCamera cam_;      // abstract camera
-    mjvOption opt_;      // visualization options
-    mjvScene scn_;       // abstract scene
-    mjrContext con_;     // custom GPU context
+
+    double reset_noise_scale_ = 0.1;  // Scale of the noise added to the initial state
 
     std::vector<double> init_qpos_;  // Initial positions
     std::vector<double> init_qvel_;  // Initial velocities
 
-    std::string model_path_;  // Absolute path to model xml file
+    /// Initial states of the episodes, shared by the clones. Must be cleared
+    /// if init_qpos_, init_qvel_ or reset_noise_scale_ change.
+    std::shared_ptr<MujocoStateCache> state_cache_;
+
     int frame_skip_ = 1;  // Number of frames per simlation step
     int obs_size_;  // Number of variables in observation vector
+    bool post_constraint_valid_ = false;  // Are cacc, cfrc_int and cfrc_ext up to date
 
-    void initialize_simulation();
+    /// Preallocate mjData for nbInstances environments sharing the model.
+    void reserve_instances(size_t nbInstances);
 
     void set_state(std::vector<double>& qpos, std::vector<double>& qvel);
 
-	void computeState();
-
-    void do_simulation(std::vector<double>& ctrl, int n_frames);
+    /// Save the simulation state and the observation in snapshot.
+    void get_snapshot(MujocoStateSnapshot& snapshot) const;
+
+    /**
+    * \brief Restore a state saved with get_snapshot().
+    *
+    * The whole mjData is copied back, derived quantities included, so that
+    * it is the mjData of a reset without the cache and no mj_forward() is
+    * needed.
+    */
+    void restore_snapshot(const MujocoStateSnapshot& snapshot);
+
+    /**
+    * \brief Write the observation of the current simulation state in
+    * currentState.
+    *
+    * By default, the observation is qpos followed by qvel.
+    */
+    virtual void computeState();
+
+    void do_simulation(const ActionView& ctrl, int n_frames);
+
+    /**
+    * \brief Compute the force-related quantities (cacc, cfrc_int, cfrc_ext)
+    * if they are not up to date.
+    *
+    * The post-constraint pass is costly and only needed when contact forces
+    * are used, so do_simulation() does not run it.
+    */
+    void ensure_post_constraint();
+
+    /// Duration of one environment step: timestep * frame_skip_.
+    double dt() const;
+
+    /// Sum of the squared actions, weighted.
+    double control_cost(double weight, const ActionView& action) const;
+
+    /// Position along x of the center of mass of the bodies.
+    double mass_center_x() const;
+
+    static std::string ExpandEnvVars(const std::string &str);
 
 };
 
@@ -0,0 +1,217 @@
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <inttypes.h>
+#include <getopt.h>
+
+extern "C" {
+#include "externHeader.h"
+#include "pendulum.h"
+	/// instantiate global variable used to communicate between the TPG and the environment
+	double* in1;
+}
+
+#include "../Learn/pendulum.h"
+#include "../Learn/instructions.h"
+
+/**
+* \brief Latency statistics of an inference engine, in nanoseconds per
+* decision.
+*/
+struct LatencyStats
+{
+	uint64_t nbDecisions = 0;
+	double medianNs = 0.0;
+	double p99Ns = 0.0;
+	double meanNs = 0.0;
+	double minNs = 0.0;
+	double maxNs = 0.0;
+
+	/// Compute the statistics of the given latencies, which are reordered.
+	LatencyStats(std::vector<double>& latencies)
+	{
+		nbDecisions = latencies.size();
+		if (latencies.empty()) {
+			return;
+		}
+		medianNs = percentile(latencies, 0.5);
+		p99Ns = percentile(latencies, 0.99);
+		minNs = *std::min_element(latencies.begin(), latencies.end());
+		maxNs = *std::max_element(latencies.begin(), latencies.end());
+		double sum = 0.0;
+		for (double latency : latencies) {
+			sum += latency;
+		}
+		meanNs = sum / (double)latencies.size();
+	}
+
+	/// Nearest-rank percentile of the latencies, which are reordered.
+	static double percentile(std::vector<double>& latencies, double ratio)
+	{
+		size_t rank = (size_t)std::ceil(ratio * (double)latencies.size());
+		size_t index = (rank > 0) ? rank - 1 : 0;
+		std::nth_element(latencies.begin(), latencies.begin() + index, latencies.end());
+		return latencies[index];
+	}
+
+	/// Write the statistics as a JSON object.
+	void writeJson(std::ostream& out) const
+	{
+		out << "{\"nbDecisions\": " << nbDecisions
+			<< ", \"medianNs\": " << medianNs
+			<< ", \"p99Ns\": " << p99Ns
+			<< ", \"meanNs\": " << meanNs
+			<< ", \"minNs\": " << minNs
+			<< ", \"maxNs\": " << maxNs << "}";
+	}
+};
+
+/**
+* \brief Run one episode per seed, timing only the inference of each decision.
+*
+* The environment is stepped between two decisions, outside the timed
+* interval. Nothing is printed during the episodes.
+*
+* \param[in] le the pendulum, whose state is pointed by in1.
+* \param[in] nbSeeds number of episodes, with seeds 0 to nbSeeds-1.
+* \param[in] maxNbActions maximum number of decisions per episode.
+* \param[in] infer function returning the action ID for the current state.
+* \param[out] latencies the duration of each decision, in nanoseconds.
+* \param[out] actions the action ID of each decision.
+*/
+template <class Inference>
+void runEpisodes(Pendulum& le, uint64_t nbSeeds, uint64_t maxNbActions, Inference infer,
+	std::vector<double>& latencies, std::vector<uint64_t>& actions)
+{
+	latencies.clear();
+	actions.clear();
+	latencies.reserve(nbSeeds * maxNbActions);
+	actions.reserve(nbSeeds * maxNbActions);
+	for (uint64_t seed = 0; seed < nbSeeds; seed++) {
+		le.reset(seed);
+		for (uint64_t nbActions = 0; nbActions < maxNbActions && !le.isTerminal(); nbActions++) {
+			auto start = std::chrono::steady_clock::now();
+			uint64_t action = infer();
+			auto stop = std::chrono::steady_clock::now();
+
+			latencies.push_back(std::chrono::duration<double, std::nano>(stop - start).count());
+			actions.push_back(action);
+			le.doAction((double)action);
+		}
+	}
+}
+
+int main(int argc, char** argv) {
+
+	char option;
+	uint64_t nbSeeds = 100;
+	uint64_t maxNbActions = 1000;
+	std::string outputPath("inferenceBenchmark.json");
+	while ((option = getopt(argc, argv, "n:a:o:")) != -1) {
+		switch (option) {
+		case 'n': nbSeeds = atoll(optarg); break;
+		case 'a': maxNbActions = atoll(optarg); break;
+		case 'o': outputPath = optarg; break;
+		default: std::cout << "Unrecognised option. Valid options are \'-n nbSeeds\' \'-a maxNbActions\' \'-o output.json\'." << std::endl; exit(1);
+		}
+	}
+
+	// Setup instructions
+	Instructions::Set set;
+	fillInstructionSet(set);
+
+	/// initialise the environment, with the actions of the graph
+	auto le = Pendulum({ 0.05, 0.1, 0.2, 0.4, 0.6, 0.8, 1.0 });
+
+	// Load parameters
+	Learn::LearningParameters params;
+	File::ParametersParser::loadParametersFromJson(
+		ROOT_DIR "/params.json", params);
+
+	// Load graph from dot file, from which the code was generated
+	std::string path(ROOT_DIR "/src/CodeGen/");
+	Environment dotEnv(set, le.getDataSources(), params.nbRegisters, params.nbProgramConstant);
+	TPG::TPGGraph dotGraph(dotEnv);
+	std::string filename(path + "Pendulum_out_best.dot");
+	File::TPGGraphDotImporter dot(filename.c_str(), dotEnv, dotGraph);
+	dot.importGraph();
+
+	/// fetch data in the environment
+	auto dataSources = le.getDataSources();
+	auto& st = dataSources.at(0).get();
+	auto dataSharedPointer = st.getDataAt(typeid(double), 0).getSharedPointer<double>();
+	in1 = dataSharedPointer.get();
+
+	// Prepare for inference
+	TPG::TPGExecutionEngine tee(dotEnv);
+	const TPG::TPGVertex* root(dotGraph.getRootVertices().back());
+
+	// Same discrete execution as inferenceTPG(), as in mainTPGInference
+	auto interpreter = [&]() {
+		return ((const TPG::TPGAction*)tee.executeFromRoot(*root).back())->getActionID();
+	};
+	auto codeGen = []() {
+		return (uint64_t)inferenceTPG();
+	};
+
+	// Warm up caches and branch predictors with a short run of each engine
+	std::vector<double> interpreterLatencies, codeGenLatencies;
+	std::vector<uint64_t> interpreterActions, codeGenActions;
+	runEpisodes(le, 1, maxNbActions, interpreter, interpreterLatencies, interpreterActions);
+	runEpisodes(le, 1, maxNbActions, codeGen, codeGenLatencies, codeGenActions);
+
+	runEpisodes(le, nbSeeds, maxNbActions, interpreter, interpreterLatencies, interpreterActions);
+	runEpisodes(le, nbSeeds, maxNbActions, codeGen, codeGenLatencies, codeGenActions);
+
+	// Both engines execute the same graph, so they should take the same decisions
+	uint64_t nbDifferentActions = 0;
+	size_t nbCompared = std::min(interpreterActions.size(), codeGenActions.size());
+	for (size_t i = 0; i < nbCompared; i++) {
+		nbDifferentActions += (interpreterActions[i] != codeGenActions[i]) ? 1 : 0;
+	}
+	nbDifferentActions += std::max(interpreterActions.size(), codeGenActions.size()) - nbCompared;
+
+	// Cost of the timing itself, included in each latency
+	std::vector<double> clockLatencies(10000);
+	for (double& latency : clockLatencies) {
+		auto start = std::chrono::steady_clock::now();
+		auto stop = std::chrono::steady_clock::now();
+		latency = std::chrono::duration<double, std::nano>(stop - start).count();
+	}
+
+	LatencyStats interpreterStats(interpreterLatencies);
+	LatencyStats codeGenStats(codeGenLatencies);
+	LatencyStats clockStats(clockLatencies);
+
+	std::ofstream json(outputPath);
+	if (!json.is_open()) {
+		std::cout << "Could not open " << outputPath << std::endl;
+		exit(1);
+	}
+	json << "{\n";
+	json << "\t\"benchmark\": \"pendulumInference\",\n";
+	json << "\t\"graph\": \"" << filename << "\",\n";
+	json << "\t\"nbSeeds\": " << nbSeeds << ",\n";
+	json << "\t\"maxNbActions\": " << maxNbActions << ",\n";
+	json << "\t\"clockOverhead\": ";
+	clockStats.writeJson(json);
+	json << ",\n\t\"interpreter\": ";
+	interpreterStats.writeJson(json);
+	json << ",\n\t\"codeGen\": ";
+	codeGenStats.writeJson(json);
+	json << ",\n\t\"nbDifferentActions\": " << nbDifferentActions << "\n";
+	json << "}\n";
+	json.close();
+
+	std::cout << "Decisions: " << interpreterStats.nbDecisions << " interpreter, " << codeGenStats.nbDecisions << " generated code" << std::endl;
+	std::cout << "Interpreter median/p99 (ns): " << interpreterStats.medianNs << " / " << interpreterStats.p99Ns << std::endl;
+	std::cout << "Generated code median/p99 (ns): " << codeGenStats.medianNs << " / " << codeGenStats.p99Ns << std::endl;
+	std::cout << "Different actions: " << nbDifferentActions << std::endl;
+	std::cout << "Results written in " << outputPath << std::endl;
+
+	return 0;
+}
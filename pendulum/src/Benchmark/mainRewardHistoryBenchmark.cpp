@@ -0,0 +1,90 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+#include "../Learn/rewardHistory.h"
+
+/**
+* \brief Former stability check: the whole history is summed at each step.
+*/
+template <size_t SIZE>
+class SummedRewardHistory
+{
+protected:
+	double rewards[SIZE];
+	size_t nbRewards = 0;
+
+public:
+	void push(double reward)
+	{
+		rewards[nbRewards % SIZE] = reward;
+		nbRewards++;
+	}
+
+	bool isFull() const { return nbRewards >= SIZE; }
+
+	double getMean() const
+	{
+		double accumulatedReward = 0.0;
+		for (size_t idx = 0; idx < SIZE; idx++) {
+			accumulatedReward += rewards[idx];
+		}
+		return accumulatedReward / (double)SIZE;
+	}
+};
+
+/**
+* \brief Push nbSteps rewards in a history, checking the stability after
+* each one as Pendulum::doAction() and isTerminal() do, and return the
+* number of nanoseconds per step.
+*/
+template <class History>
+double runSteps(uint64_t nbSteps, double& checksum)
+{
+	History history;
+	uint64_t nbStable = 0;
+
+	auto start = std::chrono::steady_clock::now();
+	for (uint64_t i = 0; i < nbSteps; i++) {
+		// Rewards decreasing towards 0, as for a stabilized pendulum.
+		history.push(-1.0 / (double)(i % 1000 + 1));
+		if (history.isFull() && std::fabs(history.getMean()) < 0.1) {
+			nbStable++;
+		}
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	// Prevent the loop from being optimized away.
+	checksum += (double)nbStable + (history.isFull() ? history.getMean() : 0.0);
+	return std::chrono::duration<double, std::nano>(end - start).count() / (double)nbSteps;
+}
+
+template <size_t SIZE>
+void compare(uint64_t nbSteps, double& checksum)
+{
+	double summed = runSteps<SummedRewardHistory<SIZE>>(nbSteps, checksum);
+	double windowed = runSteps<RewardHistory<SIZE>>(nbSteps, checksum);
+	std::cout << SIZE << "\t" << summed << "\t" << windowed << std::endl;
+}
+
+int main(int argc, char** argv) {
+
+	// Usage: pendulumRewardHistoryBenchmark [nbSteps]
+	uint64_t nbSteps = (argc > 1) ? atoll(argv[1]) : 10000000;
+	if (nbSteps == 0) {
+		std::cout << "Usage: " << argv[0] << " [nbSteps]" << std::endl;
+		exit(1);
+	}
+
+	double checksum = 0.0;
+	std::cout << "Steps: " << nbSteps << ", ns per step" << std::endl;
+	std::cout << "REWARD_HISTORY_SIZE\tsummed\twindowed" << std::endl;
+	compare<50>(nbSteps, checksum);
+	compare<300>(nbSteps, checksum);
+	compare<1000>(nbSteps, checksum);
+	compare<5000>(nbSteps, checksum);
+	std::cout << "(checksum " << checksum << ")" << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,65 @@
+#include <iostream>
+#include <cstring>
+#include <inttypes.h>
+#include <getopt.h>
+
+#include <gegelati.h>
+
+#include "../Learn/pendulum.h"
+#include "../Learn/instructions.h"
+#include "continuousTPGGenerationEngine.h"
+
+int main(int argc, char** argv) {
+
+	char option;
+	char paramFile[150];
+	char dotPath[150];
+	bool velocity = 1;
+	strcpy(paramFile, ROOT_DIR "/params/params.json");
+	strcpy(dotPath, "");
+	while ((option = getopt(argc, argv, "p:d:v:")) != -1) {
+		switch (option) {
+		case 'p': strcpy(paramFile, optarg); break;
+		case 'd': strcpy(dotPath, optarg); break;
+		case 'v': velocity = atoi(optarg); break;
+		default: std::cout << "Unrecognised option. Valid options are \'-p paramFile.json\' \'-d dot path\' \'-v velocity\'." << std::endl; exit(1);
+		}
+	}
+	if (strlen(dotPath) == 0) {
+		std::cout << "No dot file given, use \'-d dot path\' with the out_best dot file of a training with \'-c 1\'." << std::endl;
+		exit(1);
+	}
+
+	std::cout << "Generate continuous C code from pre-trained dot file " << dotPath << "." << std::endl;
+
+	// Create the instruction set for programs
+	Instructions::Set set;
+	fillInstructionSet(set);
+
+	Learn::LearningParameters params;
+	File::ParametersParser::loadParametersFromJson(paramFile, params);
+	if (params.useMemoryRegisters) {
+		// Registers kept between executions are not part of the generated code.
+		std::cout << "TPGs using memory registers can not be compiled." << std::endl;
+		exit(1);
+	}
+
+	// Continuous pendulum, as trained with '-c 1'
+	Pendulum le({ 0.05, 0.1, 0.2, 0.4, 0.6, 0.8, 1.0 }, velocity, true);
+
+	Environment dotEnv(set, le.getDataSources(), params.nbRegisters, params.nbProgramConstant);
+	TPG::TPGGraph dotGraph(dotEnv);
+	File::TPGGraphDotImporter dot(dotPath, dotEnv, dotGraph);
+	dot.importGraph();
+	if (dotGraph.getNbRootVertices() != 1) {
+		std::cout << "The dot file must contain a single root, use the out_best dot file of the training." << std::endl;
+		exit(1);
+	}
+
+	// Discrete inference of GEGELATI, and continuous inference from the bids
+	// of its programs
+	ContinuousTPGGenerationEngine tpggen("pendulumContinuous", dotGraph, "src/");
+	tpggen.generateContinuousTPG(le.getInitActions(), le.getActivationFunction());
+
+	return 0;
+}
@@ -0,0 +1,124 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <vector>
+#include <inttypes.h>
+#include <getopt.h>
+
+extern "C" {
+#include "externHeader.h"
+#include "pendulumContinuous_continuous.h"
+	/// instantiate global variable used to communicate between the TPG and the environment
+	double* in1;
+}
+
+#include "../Learn/pendulum.h"
+#include "../Learn/instructions.h"
+
+/**
+* Check the generated continuous inference against the TPGExecutionEngine.
+*
+* Both engines infer the actions of the same states: the pendulum follows
+* the actions of the TPGExecutionEngine, and the actions of the generated
+* code are compared to them at each step.
+*/
+int main(int argc, char** argv) {
+
+	char option;
+	uint64_t nbSeeds = 10;
+	char paramFile[150];
+	char dotPath[150];
+	bool velocity = 1;
+	strcpy(paramFile, ROOT_DIR "/params/params.json");
+	strcpy(dotPath, "");
+	while ((option = getopt(argc, argv, "n:p:d:v:")) != -1) {
+		switch (option) {
+		case 'n': nbSeeds = atoll(optarg); break;
+		case 'p': strcpy(paramFile, optarg); break;
+		case 'd': strcpy(dotPath, optarg); break;
+		case 'v': velocity = atoi(optarg); break;
+		default: std::cout << "Unrecognised option. Valid options are \'-n nbSeeds\' \'-p paramFile.json\' \'-d dot path\' \'-v velocity\'." << std::endl; exit(1);
+		}
+	}
+	if (strlen(dotPath) == 0) {
+		std::cout << "No dot file given, use \'-d dot path\' with the dot file the code was generated from." << std::endl;
+		exit(1);
+	}
+
+	// Setup instructions
+	Instructions::Set set;
+	fillInstructionSet(set);
+
+	Learn::LearningParameters params;
+	File::ParametersParser::loadParametersFromJson(paramFile, params);
+
+	// Continuous pendulum, as trained with '-c 1'
+	Pendulum le({ 0.05, 0.1, 0.2, 0.4, 0.6, 0.8, 1.0 }, velocity, true);
+	if (le.getInitActions().size() != PENDULUMCONTINUOUS_NB_CONTINUOUS_ACTIONS) {
+		std::cout << "The generated code fills " << PENDULUMCONTINUOUS_NB_CONTINUOUS_ACTIONS << " actions, the pendulum has " << le.getInitActions().size() << "." << std::endl;
+		exit(1);
+	}
+
+	// Load graph from dot file, from which the code was generated
+	Environment dotEnv(set, le.getDataSources(), params.nbRegisters, params.nbProgramConstant);
+	TPG::TPGGraph dotGraph(dotEnv);
+	File::TPGGraphDotImporter dot(dotPath, dotEnv, dotGraph);
+	dot.importGraph();
+
+	/// fetch data in the environment
+	auto dataSources = le.getDataSources();
+	auto& st = dataSources.at(0).get();
+	auto dataSharedPointer = st.getDataAt(typeid(double), 0).getSharedPointer<double>();
+	in1 = dataSharedPointer.get();
+
+	TPG::TPGExecutionEngine tee(dotEnv);
+	const TPG::TPGVertex* root(dotGraph.getRootVertices().back());
+	const std::vector<double> initActions = le.getInitActions();
+	const std::string activation = le.getActivationFunction();
+
+	std::vector<double> codeGenActions(PENDULUMCONTINUOUS_NB_CONTINUOUS_ACTIONS);
+	uint64_t nbSteps = 0;
+	uint64_t nbDifferentActions = 0;
+	double maxDifference = 0.0;
+	double interpreterTime = 0.0;
+	double codeGenTime = 0.0;
+	for (uint64_t seed = 0; seed < nbSeeds; seed++) {
+		le.reset(seed, Learn::LearningMode::VALIDATION);
+		uint64_t nbActions = 0;
+		while (!le.isTerminal() && nbActions < params.maxNbActionsPerEval) {
+			auto start = std::chrono::steady_clock::now();
+			std::vector<double> actions = tee.executeFromRoot(*root, initActions, 1, activation).second;
+			auto middle = std::chrono::steady_clock::now();
+			inferenceContinuousTPG(codeGenActions.data());
+			auto stop = std::chrono::steady_clock::now();
+			interpreterTime += std::chrono::duration<double>(middle - start).count();
+			codeGenTime += std::chrono::duration<double>(stop - middle).count();
+
+			// NaN actions are equal when both engines compute them
+			bool isDifferent = actions.size() != codeGenActions.size();
+			for (size_t i = 0; !isDifferent && i < actions.size(); i++) {
+				double difference = std::fabs(actions[i] - codeGenActions[i]);
+				if (std::isnan(actions[i]) != std::isnan(codeGenActions[i]) || difference > 1e-9) {
+					isDifferent = true;
+				}
+				else if (!std::isnan(difference) && difference > maxDifference) {
+					maxDifference = difference;
+				}
+			}
+			nbDifferentActions += isDifferent ? 1 : 0;
+
+			le.doAction(actions.at(0));
+			nbActions++;
+		}
+		nbSteps += nbActions;
+		std::cout << "Seed " << seed << ": score " << le.getScore() << " in " << nbActions << " actions." << std::endl;
+	}
+
+	std::cout << std::setprecision(6) << "Interpreter time: " << interpreterTime << " s for " << nbSteps << " actions." << std::endl;
+	std::cout << std::setprecision(6) << "Generated code time: " << codeGenTime << " s for " << nbSteps << " actions." << std::endl;
+	std::cout << "Different actions: " << nbDifferentActions << " (largest matching difference " << maxDifference << ")" << std::endl;
+
+	return (nbDifferentActions == 0) ? 0 : 1;
+}
@@ -0,0 +1,188 @@
+#define _USE_MATH_DEFINES // To get M_PI
+#include <math.h>
+
+#include "batchedPendulum.h"
+
+/**
+* \brief Round to the nearest integer, for |x| < 2^51.
+*
+* Adding and subtracting 1.5 * 2^52 drops the fractional bits in the
+* current rounding mode, unless the compiler reassociates floating-point
+* operations (-ffast-math). Contrary to std::round, this does not call libm
+* and vectorizes without SSE4.1.
+*/
+static inline double roundToNearest(double x)
+{
+	const double MAGIC = 6755399441055744.0;
+	return (x + MAGIC) - MAGIC;
+}
+
+/**
+* \brief Same as std::trunc(), for |x| < 2^31.
+*
+* The conversion to a 32-bit integer vectorizes without SSE4.1, contrary to
+* a 64-bit one. Angles are far below 2^31 turns.
+*/
+static inline double truncate(double x)
+{
+	return (double)(int32_t)x;
+}
+
+/// Same as std::fmod(x, y), up to rounding, for |x / y| < 2^31.
+static inline double modulo(double x, double y)
+{
+	return x - truncate(x / y) * y;
+}
+
+/**
+* \brief Sine, within a few ulps of std::sin() for |x| < 2^20.
+*
+* The argument is reduced to r in [-PI/2; PI/2] with x = r + k * PI, then
+* sin(r) is evaluated with its Taylor series up to r^19, whose truncation
+* error is below 3e-16.
+*/
+static inline double sine(double x)
+{
+	// PI split as in fdlibm: PI_HIGH has 33 significant bits, so that
+	// k * PI_HIGH is exact for |k| < 2^20.
+	const double PI_HIGH = 3.14159265346825122834;
+	const double PI_LOW = 1.21542010130123844986e-10;
+	double k = roundToNearest(x * (1.0 / M_PI));
+	double r = (x - k * PI_HIGH) - k * PI_LOW;
+
+	double r2 = r * r;
+	double p = -1.0 / 121645100408832000.0;
+	p = p * r2 + 1.0 / 355687428096000.0;
+	p = p * r2 - 1.0 / 1307674368000.0;
+	p = p * r2 + 1.0 / 6227020800.0;
+	p = p * r2 - 1.0 / 39916800.0;
+	p = p * r2 + 1.0 / 362880.0;
+	p = p * r2 - 1.0 / 5040.0;
+	p = p * r2 + 1.0 / 120.0;
+	p = p * r2 - 1.0 / 6.0;
+	double sinR = r + r * r2 * p;
+
+	// sin(r + k * PI) = (-1)^k * sin(r)
+	double isOdd = k - 2.0 * roundToNearest(k * 0.5 - 0.25);
+	return sinR * (1.0 - 2.0 * isOdd);
+}
+
+BatchedPendulum::BatchedPendulum(const Pendulum& model, size_t size) :
+	availableActions{ model.availableActions }, isDiscrete{ model.isDiscreteEnvironment },
+	angle(size, 0.0), velocity(size, 0.0), torque(size, 0.0), reward(size, 0.0), active(size, 0),
+	rewardHistory(size), totalReward(size, 0.0), nbActionsExecuted(size, 0),
+	nbActive{ 0 }
+{
+}
+
+void BatchedPendulum::reset(size_t index, size_t seed, Learn::LearningMode mode)
+{
+	// Same seed and draws as Pendulum::reset()
+	size_t hash_seed = Data::Hash<size_t>()(seed) ^ Data::Hash<Learn::LearningMode>()(mode);
+	if (mode == Learn::LearningMode::VALIDATION) {
+		hash_seed = 6416846135168433;
+	}
+	Mutator::RNG rng(hash_seed);
+
+	this->angle[index] = rng.getDouble(-M_PI, M_PI);
+	this->velocity[index] = rng.getDouble(-1.0, 1.0);
+	this->torque[index] = 0.0;
+	this->nbActionsExecuted[index] = 0;
+	this->totalReward[index] = 0.0;
+	this->rewardHistory[index].clear();
+	if (!this->active[index]) {
+		this->active[index] = 1;
+		this->nbActive++;
+	}
+}
+
+void BatchedPendulum::setAction(size_t index, double actionID)
+{
+	double currentAction = actionID;
+	if (this->isDiscrete) {
+		uint64_t id = (uint64_t)actionID;
+		double result = (id == 0) ? 0.0 : this->availableActions.at((id - 1) % this->availableActions.size());
+		currentAction = (id <= this->availableActions.size()) ? result : -result;
+	}
+	this->torque[index] = currentAction * Pendulum::MAX_TORQUE;
+}
+
+void BatchedPendulum::step()
+{
+	const size_t nbPendulums = this->size();
+	const double G = Pendulum::G;
+	const double LENGTH = Pendulum::LENGTH;
+	const double MASS = Pendulum::MASS;
+	const double TIME_DELTA = Pendulum::TIME_DELTA;
+	const double MAX_SPEED = Pendulum::MAX_SPEED;
+	double* angles = this->angle.data();
+	double* velocities = this->velocity.data();
+	const double* torques = this->torque.data();
+	double* rewards = this->reward.data();
+	const uint8_t* actives = this->active.data();
+
+	// Same computations as Pendulum::doAction(), with vectorizable modulo and
+	// sine instead of the libm calls, and without branches, so that the loop
+	// is vectorized. Inactive pendulums keep their state.
+	for (size_t i = 0; i < nbPendulums; i++) {
+		double angle = angles[i];
+		double velocity = velocities[i];
+		double currentAction = torques[i];
+
+		double angleToUpward = modulo((angle + M_PI), (2.f * M_PI)) - M_PI;
+		rewards[i] = -((angleToUpward * angleToUpward) + 0.1f * (velocity * velocity) + 0.001f * (currentAction * currentAction));
+
+		double newVelocity = velocity + ((-3.0) * G / (2.0 * LENGTH) * (sine(angle + M_PI)) +
+			(3.f / (MASS * LENGTH * LENGTH)) * currentAction) * TIME_DELTA;
+		newVelocity = std::min(std::max(newVelocity, -MAX_SPEED), MAX_SPEED);
+		// Inactive pendulums move by 0.0, so that all the operations of an
+		// iteration are executed and the loop has no control flow.
+		double move = actives[i] ? newVelocity : 0.0;
+
+		velocities[i] = actives[i] ? newVelocity : velocity;
+		angles[i] = angle + move * TIME_DELTA;
+	}
+
+	// Store and accumulate the rewards of the active pendulums
+	for (size_t i = 0; i < nbPendulums; i++) {
+		if (!actives[i]) {
+			continue;
+		}
+		this->rewardHistory[i].push(rewards[i]);
+		this->nbActionsExecuted[i]++;
+		this->totalReward[i] += rewards[i];
+		if (this->isTerminal(i)) {
+			this->active[i] = 0;
+			this->nbActive--;
+		}
+	}
+}
+
+void BatchedPendulum::loadState(size_t index, Pendulum& le) const
+{
+	le.setAngle(this->angle[index]);
+	le.setVelocity(this->velocity[index]);
+}
+
+bool BatchedPendulum::isTerminal(size_t index) const
+{
+	bool result = false;
+
+	// Is the history long enough to check stability
+	if (this->rewardHistory[index].isFull()) {
+		// Check stability of the mean reward
+		result = (fabs(this->rewardHistory[index].getMean()) < Pendulum::STABILITY_THRESHOLD);
+	}
+	return result;
+}
+
+double BatchedPendulum::getScore(size_t index) const
+{
+	if (this->isTerminal(index)) {
+		// Same score as Pendulum::getScore()
+		return 10.0 / std::log(((double)this->nbActionsExecuted[index] - (double)REWARD_HISTORY_SIZE + 2.0));
+	}
+	else {
+		return this->totalReward[index] / (double)this->nbActionsExecuted[index];
+	}
+}
@@ -0,0 +1,107 @@
+#ifndef BATCHED_PENDULUM_H
+#define BATCHED_PENDULUM_H
+
+#include <vector>
+
+#include <gegelati.h>
+
+#include "pendulum.h"
+#include "rewardHistory.h"
+
+/**
+* \brief Many inverted pendulums simulated in lockstep.
+*
+* The state of the pendulums is stored as a structure of arrays, so that all
+* the pendulums are stepped by a single loop over contiguous arrays, which
+* the compiler can vectorize. Each pendulum behaves as a Pendulum
+* LearningEnvironment with the same actions, reset with the same seed, up to
+* the rounding of the modulo and sine computed without libm in step().
+*
+* Pendulums reaching a terminal state stop moving until their next reset.
+*/
+class BatchedPendulum
+{
+protected:
+	/// Number of rewards kept to check the stability of a pendulum.
+	static const size_t REWARD_HISTORY_SIZE = Pendulum::REWARD_HISTORY_SIZE;
+
+	/// Available actions, as in Pendulum.
+	const std::vector<double> availableActions;
+
+	/// Whether actions are IDs of availableActions, or torques.
+	bool isDiscrete;
+
+	/// Current angle of each pendulum.
+	std::vector<double> angle;
+
+	/// Current velocity of each pendulum.
+	std::vector<double> velocity;
+
+	/// Torque applied to each pendulum at the next step.
+	std::vector<double> torque;
+
+	/// Reward of the last step of each pendulum.
+	std::vector<double> reward;
+
+	/// Whether each pendulum is still moving.
+	std::vector<uint8_t> active;
+
+	/// Last REWARD_HISTORY_SIZE rewards of each pendulum.
+	std::vector<RewardHistory<REWARD_HISTORY_SIZE>> rewardHistory;
+
+	/// Total reward of each pendulum since its reset.
+	std::vector<double> totalReward;
+
+	/// Number of actions executed by each pendulum since its reset.
+	std::vector<uint64_t> nbActionsExecuted;
+
+	/// Number of active pendulums.
+	size_t nbActive;
+
+public:
+	/**
+	* \brief Constructor.
+	*
+	* \param[in] model the Pendulum whose actions are used.
+	* \param[in] size number of pendulums.
+	*/
+	BatchedPendulum(const Pendulum& model, size_t size);
+
+	/// Get the number of pendulums.
+	size_t size() const { return angle.size(); }
+
+	/// Get the number of pendulums still moving.
+	size_t getNbActive() const { return nbActive; }
+
+	/// Whether a pendulum is still moving.
+	bool isActive(size_t index) const { return active[index] != 0; }
+
+	/// Reset a pendulum, as Pendulum::reset() with the same seed and mode.
+	void reset(size_t index, size_t seed, Learn::LearningMode mode);
+
+	/**
+	* \brief Set the action applied to a pendulum at the next step.
+	*
+	* \param[in] index the pendulum.
+	* \param[in] actionID action ID in a discrete environment, or torque
+	* ratio in [-1; 1] in a continuous one, as in Pendulum::doAction().
+	*/
+	void setAction(size_t index, double actionID);
+
+	/// Step all the active pendulums, and deactivate the terminal ones.
+	void step();
+
+	/**
+	* \brief Copy the state of a pendulum into the data sources of a
+	* Pendulum, for the execution of a TPG.
+	*/
+	void loadState(size_t index, Pendulum& le) const;
+
+	/// Same as Pendulum::isTerminal(), for a pendulum.
+	bool isTerminal(size_t index) const;
+
+	/// Same as Pendulum::getScore(), for a pendulum.
+	double getScore(size_t index) const;
+};
+
+#endif // !BATCHED_PENDULUM_H
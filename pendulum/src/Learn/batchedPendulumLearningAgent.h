@@ -0,0 +1,156 @@
+#ifndef BATCHED_PENDULUM_LEARNING_AGENT_H
+#define BATCHED_PENDULUM_LEARNING_AGENT_H
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gegelati.h>
+
+#include "pendulum.h"
+#include "batchedPendulum.h"
+
+/**
+* \brief LearningAgent evaluating the Pendulum roots in lockstep.
+*
+* In TRAINING mode, the roots are split in one group per thread. The roots
+* of a group are evaluated together on a BatchedPendulum: at each step, each
+* root selects the action of its own pendulum, then all the pendulums are
+* stepped at once. Other modes are evaluated by the BaseAgent.
+*
+* As in LearningAgent::evaluateJob(), roots already evaluated
+* maxNbEvaluationPerPolicy times keep their result, and new results are
+* combined with the previous ones. Differences with the BaseAgent:
+* - all the roots are reset with the same seeds, derived from the
+* generation and iteration numbers;
+* - program executions are not recorded in the Archive.
+*
+* \tparam BaseAgent the LearningAgent used for the other modes.
+*/
+template <class BaseAgent = Learn::ParallelLearningAgent>
+class BatchedPendulumLearningAgent : public BaseAgent
+{
+protected:
+	/// Whether TRAINING roots are evaluated in lockstep.
+	bool lockstepEvaluation = true;
+
+	/**
+	* \brief Evaluate roots in lockstep.
+	*
+	* \param[in] model the Pendulum whose actions and data sources are used.
+	* \param[in] roots the roots to evaluate.
+	* \param[in] generationNumber the current generation.
+	* \param[out] results the average score of each root.
+	*/
+	void evaluateInLockstep(const Pendulum& model, const std::vector<const TPG::TPGVertex*>& roots,
+		uint64_t generationNumber, std::vector<double>& results) const
+	{
+		// Private Pendulum providing the data sources to the programs
+		Pendulum le(model);
+		const Environment& agentEnv = this->tpg->getEnvironment();
+		Environment env(agentEnv.getInstructionSet(), le.getDataSources(), agentEnv.getNbRegisters(), agentEnv.getNbConstant());
+		TPG::TPGExecutionEngine tee(env, NULL);
+
+		BatchedPendulum batch(model, roots.size());
+		results.assign(roots.size(), 0.0);
+		for (uint64_t iterationNumber = 0; iterationNumber < this->params.nbIterationsPerPolicyEvaluation; iterationNumber++) {
+			Data::Hash<uint64_t> hasher;
+			size_t seed = hasher(generationNumber) ^ hasher(iterationNumber);
+			for (size_t i = 0; i < roots.size(); i++) {
+				batch.reset(i, seed, Learn::LearningMode::TRAINING);
+			}
+
+			for (uint64_t nbActions = 0; nbActions < this->params.maxNbActionsPerEval && batch.getNbActive() > 0; nbActions++) {
+				for (size_t i = 0; i < roots.size(); i++) {
+					if (batch.isActive(i)) {
+						batch.loadState(i, le);
+						std::vector<double> actions = tee.executeFromRoot(*roots[i], le.getInitActions(), 1, le.getActivationFunction()).second;
+						batch.setAction(i, actions.at(0));
+					}
+				}
+				batch.step();
+			}
+
+			for (size_t i = 0; i < roots.size(); i++) {
+				results[i] += batch.getScore(i);
+			}
+		}
+		for (double& result : results) {
+			result /= (double)this->params.nbIterationsPerPolicyEvaluation;
+		}
+	}
+
+public:
+	using BaseAgent::BaseAgent;
+
+	/// Enable or disable the lockstep evaluation of TRAINING roots.
+	void setLockstepEvaluation(bool enabled)
+	{
+		lockstepEvaluation = enabled;
+	}
+
+	/**
+	* \brief Evaluate all the roots, in lockstep in TRAINING mode.
+	*/
+	virtual std::multimap<std::shared_ptr<Learn::EvaluationResult>, const TPG::TPGVertex*>
+		evaluateAllRoots(uint64_t generationNumber, Learn::LearningMode mode) override
+	{
+		const Pendulum* model = dynamic_cast<const Pendulum*>(&this->learningEnvironment);
+		if (!lockstepEvaluation || mode != Learn::LearningMode::TRAINING || model == NULL) {
+			return BaseAgent::evaluateAllRoots(generationNumber, mode);
+		}
+
+		std::multimap<std::shared_ptr<Learn::EvaluationResult>, const TPG::TPGVertex*> results;
+
+		// Skip the roots evaluated enough times.
+		std::vector<const TPG::TPGVertex*> roots;
+		std::vector<std::shared_ptr<Learn::EvaluationResult>> previousResults;
+		for (const TPG::TPGVertex* root : this->tpg->getRootVertices()) {
+			std::shared_ptr<Learn::EvaluationResult> previousResult;
+			if (this->isRootEvalSkipped(*root, previousResult)) {
+				results.emplace(previousResult, root);
+			}
+			else {
+				roots.push_back(root);
+				previousResults.push_back(previousResult);
+			}
+		}
+
+		// One group of roots per thread
+		size_t nbGroups = std::max<size_t>(1, std::min<size_t>(this->params.nbThreads, roots.size()));
+		std::vector<std::vector<const TPG::TPGVertex*>> groups(nbGroups);
+		std::vector<std::vector<double>> groupResults(nbGroups);
+		for (size_t i = 0; i < roots.size(); i++) {
+			groups[i * nbGroups / roots.size()].push_back(roots[i]);
+		}
+		std::vector<std::thread> threads;
+		for (size_t group = 1; group < nbGroups; group++) {
+			threads.emplace_back([this, model, &groups, &groupResults, group, generationNumber]() {
+				this->evaluateInLockstep(*model, groups[group], generationNumber, groupResults[group]);
+			});
+		}
+		evaluateInLockstep(*model, groups[0], generationNumber, groupResults[0]);
+		for (std::thread& thread : threads) {
+			thread.join();
+		}
+
+		// Combine with the previous results, as LearningAgent::evaluateJob().
+		size_t index = 0;
+		for (size_t group = 0; group < nbGroups; group++) {
+			for (double score : groupResults[group]) {
+				std::shared_ptr<Learn::EvaluationResult> result =
+					std::make_shared<Learn::EvaluationResult>(score, this->params.nbIterationsPerPolicyEvaluation);
+				if (previousResults[index] != nullptr) {
+					*result += *previousResults[index];
+				}
+				results.emplace(result, roots[index]);
+				index++;
+			}
+		}
+		return results;
+	}
+};
+
+#endif // !BATCHED_PENDULUM_LEARNING_AGENT_H
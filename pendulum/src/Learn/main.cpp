@@ -10,6 +10,8 @@
 
 #include "pendulum.h"
 #include "instructions.h"
+#include "validationCacheLearningAgent.h"
+#include "batchedPendulumLearningAgent.h"
 
 int main(int argc, char ** argv) {
 
@@ -19,16 +21,18 @@ int main(int argc, char ** argv) {
 	char logsFolder[150];
 	bool velocity = 1;
 	bool isContinuous = 0;
+	bool isBatched = 0;
     strcpy(logsFolder, "logs");
     strcpy(paramFile, "params/params_0.json");
-    while((option = getopt(argc, argv, "s:p:v:c:l:")) != -1){
+    while((option = getopt(argc, argv, "s:p:v:c:l:b:")) != -1){
         switch (option) {
             case 's': seed= atoi(optarg); break;
             case 'p': strcpy(paramFile, optarg); break;
             case 'l': strcpy(logsFolder, optarg); break;
 			case 'v': velocity = atoi(optarg); break;
 			case 'c': isContinuous = atoi(optarg); break;
-            default: std::cout << "Unrecognised option. Valid options are \'-s seed\' \'-p paramFile.json\' \'-logs logs Folder\'  \'-v velocity\' \'-c isContinuous\'." << std::endl; exit(1);
+			case 'b': isBatched = atoi(optarg); break;
+            default: std::cout << "Unrecognised option. Valid options are \'-s seed\' \'-p paramFile.json\' \'-logs logs Folder\'  \'-v velocity\' \'-c isContinuous\' \'-b isBatched\'." << std::endl; exit(1);
         }
     }
     std::cout << "Selected seed : " << seed << std::endl;
@@ -59,7 +63,10 @@ int main(int argc, char ** argv) {
 	std::cout << "Number of threads: " << params.nbThreads << std::endl;
 
 	// Instantiate and init the learning agent
-	Learn::ParallelLearningAgent la(pendulumLE, set, params);
+	// (Validation scores of unchanged roots are reused across generations,
+	// training roots can be evaluated in lockstep)
+	BatchedPendulumLearningAgent<ValidationCacheLearningAgent<>> la(pendulumLE, set, params);
+	la.setLockstepEvaluation(isBatched);
 	la.init(seed);
 
 	const TPG::TPGVertex* bestRoot = NULL;
@@ -14,26 +14,26 @@ const double Pendulum::STABILITY_THRESHOLD = 0.1;
 
 void Pendulum::setAngle(double newValue)
 {
-	this->currentState.setDataAt(typeid(double), 0, newValue);
+	this->currentState.set(0, newValue);
 }
 
 void Pendulum::setVelocity(double newValue)
 {
 	if(velocityAvailable){
-		this->currentState.setDataAt(typeid(double), 1, newValue);
+		this->currentState.set(1, newValue);
 	}
 	this->currentVelocity = newValue;
 }
 
 double Pendulum::getAngle() const
 {
-	return *this->currentState.getDataAt(typeid(const double), 0).getSharedPointer<const double>();
+	return this->currentState.get(0);
 }
 
 double Pendulum::getVelocity() const
 {
 	if(velocityAvailable){
-		return *this->currentState.getDataAt(typeid(const double), 1).getSharedPointer<const double>();
+		return this->currentState.get(1);
 	}
 	return this->currentVelocity;
 }
@@ -62,6 +62,7 @@ void Pendulum::reset(size_t seed, Learn::LearningMode mode, uint16_t iterationNu
 	this->setVelocity(this->rng.getDouble(-1.0, 1.0));
 	this->nbActionsExecuted = 0;
 	this->totalReward = 0.0;
+	this->rewardHistory.clear();
 }
 
 double Pendulum::getActionFromID(const uint64_t& actionID)
@@ -91,7 +92,7 @@ void Pendulum::doAction(double actionID)
 
 	
 	// Store and accumulate reward
-	this->rewardHistory[this->nbActionsExecuted % REWARD_HISTORY_SIZE] = reward;
+	this->rewardHistory.push(reward);
 	this->nbActionsExecuted++;
 	this->totalReward += reward;
 
@@ -135,16 +136,9 @@ bool Pendulum::isTerminal() const
 	bool result = false;
 
 	// Is the history long enough to check stability
-	if (this->nbActionsExecuted >= Pendulum::REWARD_HISTORY_SIZE) {
-		// Compute mean reward
-		double accumulatedReward = 0.0;
-		for (auto idx = 0; idx < Pendulum::REWARD_HISTORY_SIZE; idx++) {
-			accumulatedReward += this->rewardHistory[idx];
-		}
-		accumulatedReward /= (double)Pendulum::REWARD_HISTORY_SIZE;
-
-		// Check stability
-		result = (fabs(accumulatedReward) < Pendulum::STABILITY_THRESHOLD);
+	if (this->rewardHistory.isFull()) {
+		// Check stability of the mean reward
+		result = (fabs(this->rewardHistory.getMean()) < Pendulum::STABILITY_THRESHOLD);
 	}
 
 	// The history is too short, or the pendulum was not stabilized.
@@ -3,6 +3,9 @@
 
 #include <gegelati.h>
 
+#include "typedStateArray.h"
+#include "rewardHistory.h"
+
 /**
 * \brief Inverted pendulum LearningEnvironment.
 *
@@ -12,6 +15,9 @@
 */
 class Pendulum : public Learn::LearningEnvironment
 {
+	/// Steps many pendulums with the same constants and actions.
+	friend class BatchedPendulum;
+
 private:
 	// Constants for the pendulum behavior
 	static const double MAX_SPEED;
@@ -40,7 +46,7 @@ private:
 	Mutator::RNG rng;
 
 	/// Reward history for score computation
-	double rewardHistory[REWARD_HISTORY_SIZE];
+	RewardHistory<REWARD_HISTORY_SIZE> rewardHistory;
 
 	/// Total reward accumulated since the last reset
 	double totalReward = 0.0;
@@ -51,7 +57,7 @@ private:
 	/// Copy of current angle and velocity provided to the LearningAgent
 	/// Current angle of the pendulum in [-M_PI; M_PI]
 	/// Current velocity of the pendulum in [-1;1]
-	Data::PrimitiveTypeArray<double> currentState;
+	TypedStateArray<double> currentState;
 
 	bool velocityAvailable;
 
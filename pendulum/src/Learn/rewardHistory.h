@@ -0,0 +1,64 @@
+#ifndef REWARD_HISTORY_H
+#define REWARD_HISTORY_H
+
+#include <cstddef>
+
+/**
+* \brief Sliding window over the last rewards of an environment.
+*
+* The sum of the rewards in the window is updated with each new reward, so
+* that its mean is available in constant time. To keep rounding errors from
+* accumulating, the sum is computed again from the window each time the
+* window wraps around, which costs O(1) per reward on average.
+*
+* \tparam SIZE number of rewards in the window.
+*/
+template <size_t SIZE>
+class RewardHistory
+{
+protected:
+	/// Last SIZE rewards, oldest overwritten first.
+	double rewards[SIZE];
+
+	/// Sum of the rewards in the window.
+	double windowSum = 0.0;
+
+	/// Number of rewards added since the last clear().
+	size_t nbRewards = 0;
+
+public:
+	/// Empty the window.
+	void clear()
+	{
+		windowSum = 0.0;
+		nbRewards = 0;
+	}
+
+	/// Add a reward, replacing the oldest one once the window is full.
+	void push(double reward)
+	{
+		size_t index = nbRewards % SIZE;
+		if (nbRewards >= SIZE) {
+			windowSum -= rewards[index];
+		}
+		rewards[index] = reward;
+		windowSum += reward;
+		nbRewards++;
+
+		// Sum the window again, in the order of the array, when it wraps.
+		if (index == SIZE - 1) {
+			windowSum = 0.0;
+			for (size_t i = 0; i < SIZE; i++) {
+				windowSum += rewards[i];
+			}
+		}
+	}
+
+	/// Whether SIZE rewards were added since the last clear().
+	bool isFull() const { return nbRewards >= SIZE; }
+
+	/// Get the mean of the rewards of a full window.
+	double getMean() const { return windowSum / (double)SIZE; }
+};
+
+#endif // !REWARD_HISTORY_H
@@ -10,6 +10,7 @@
 #include "instructions.h"
 #include "stickGameAdversarial.h"
 #include "resultTester.h"
+#include "asyncDotExporter.h"
 
 
 
@@ -44,7 +45,11 @@ int main(int argc, char* argv[]) {
 	Log::LABasicLogger logger(la);
 
 	// Create an exporter for all graphs
-	File::TPGGraphDotExporter dotExporter("out_000.dot", *la.getTPGGraph());
+	// (checkpoint period and rotation can be set with -dotPeriod and -dotKept)
+	uint64_t dotPeriod = 1;
+	size_t dotNbKept = 0;
+	AsyncDotExporter::parseCommandLine(argc, argv, dotPeriod, dotNbKept);
+	AsyncDotExporter dotExporter(*la.getTPGGraph(), dotPeriod, dotNbKept);
 
 	// File for printing best policy stat.
 	std::ofstream stats;
@@ -60,12 +65,14 @@ int main(int argc, char* argv[]) {
 	for (int i = 0; i < params.nbGenerations; i++) {
 		char buff[16];
 		sprintf(buff, "out_%03d.dot", i);
-		dotExporter.setNewFilePath(buff);
-		dotExporter.print();
+		dotExporter.checkpoint(i, buff);
 
 		la.trainOneGeneration(i);
 	}
 
+	// Wait for the checkpoints, they share their programs with the graph.
+	dotExporter.flush();
+
 	// Keep best policy
 	la.keepBestPolicy();
 
@@ -73,8 +80,8 @@ int main(int argc, char* argv[]) {
 	la.getTPGGraph()->clearProgramIntrons();
 
 	// Export the graph
-	dotExporter.setNewFilePath("out_best.dot");
-	dotExporter.print();
+	dotExporter.exportGraph("out_best.dot");
+	dotExporter.flush();
 
 	TPG::PolicyStats ps;
 	ps.setEnvironment(la.getTPGGraph()->getEnvironment());
@@ -38,9 +38,7 @@
 void StickGameAdversarial::randomPlay() {
     if (!this->isTerminal()) {
         // Get current state
-        int currentState =
-                (int)*(((this->remainingSticks.getDataAt(typeid(int), 0))
-                        .getSharedPointer<const int>()));
+        int currentState = this->remainingSticks.get(0);
         if (rng.getUnsignedInt64(0, errorRate - 1) != 0 && (currentState - 1) % 4 != 0) {
             currentState -= (currentState - 1) % 4;
         }
@@ -48,7 +46,7 @@ void StickGameAdversarial::randomPlay() {
             currentState -= (int)rng.getUnsignedInt64(1, std::min(currentState, 3));
         }
 
-        this->remainingSticks.setDataAt(typeid(int), 0, currentState);
+        this->remainingSticks.set(0, currentState);
         if (currentState == 0) {
             this->firstPlayerWon = !this->currentTurn % 2 == 0;
         }
@@ -70,14 +68,12 @@ void StickGameAdversarial::doAction(uint64_t actionID)
 
         // Execute the action
         // Get current state
-        int currentState =
-            (int)*(((this->remainingSticks.getDataAt(typeid(int), 0))
-                        .getSharedPointer<const int>()));
+        int currentState = this->remainingSticks.get(0);
         if ((actionID + 1) > currentState) {
             // Illegal move
             forbiddenMove = true;
             // and game over
-            this->remainingSticks.setDataAt(typeid(int), 0, 0);
+            this->remainingSticks.set(0, 0);
             // the opponent has won
             this->firstPlayerWon = !isFirstPlayer;
 
@@ -87,7 +83,7 @@ void StickGameAdversarial::doAction(uint64_t actionID)
         else {
             // update state
             currentState -= ((int)actionID + 1);
-            this->remainingSticks.setDataAt(typeid(int), 0, currentState);
+            this->remainingSticks.set(0, currentState);
             // if current state is now zero, the player lost
             if (currentState == 0) {
                 this->firstPlayerWon = !isFirstPlayer;
@@ -108,7 +104,7 @@ void StickGameAdversarial::reset(size_t seed, Learn::LearningMode mode, uint16_t
     size_t hash_seed =
         Data::Hash<size_t>()(seed) ^ Data::Hash<Learn::LearningMode>()(mode);
     this->rng.setSeed(hash_seed);
-    this->remainingSticks.setDataAt(typeid(int), 0, 21);
+    this->remainingSticks.set(0, 21);
     this->firstPlayerWon = false;
     this->forbiddenMoveFirstPlayer = false;
     this->forbiddenMoveSecondPlayer = false;
@@ -166,11 +162,9 @@ Learn::LearningEnvironment* StickGameAdversarial::clone() const
 
 bool StickGameAdversarial::isTerminal() const
 {
-    return (int)*((this->remainingSticks.getDataAt(typeid(int), 0))
-                      .getSharedPointer<const int>()) == 0;
+    return this->remainingSticks.get(0) == 0;
 }
 
 std::string StickGameAdversarial::toString() const{
-    return std::to_string((int)*((this->remainingSticks.getDataAt(typeid(int), 0))
-            .getSharedPointer<const int>()));
+    return std::to_string(this->remainingSticks.get(0));
 }
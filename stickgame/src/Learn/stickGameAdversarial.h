@@ -41,6 +41,8 @@
 
 #include "learn/adversarialLearningEnvironment.h"
 
+#include "typedStateArray.h"
+
 /**
  * Play the stick game against another agent
  */
@@ -48,7 +50,7 @@ class StickGameAdversarial : public Learn::AdversarialLearningEnvironment
 {
   protected:
     /// During a game, number of remaining sticks.
-    Data::PrimitiveTypeArray<int> remainingSticks;
+    TypedStateArray<int> remainingSticks;
 
     /// This source of data give useful numbers for helping undertanding the
     /// game.
@@ -1,7 +1,7 @@
 #include "TicTacToe.h"
 
 double TicTacToe::getSymbolAt(int location) const {
-    return (double) *((this->board.getDataAt(typeid(double), location)).getSharedPointer<const double>());
+    return this->board.get(location);
 }
 
 void TicTacToe::play(uint64_t actionID, double symbolOfPlayer) {
@@ -11,7 +11,7 @@ void TicTacToe::play(uint64_t actionID, double symbolOfPlayer) {
             std::cout << "Non-empty cell ! Random play is being done" << std::endl;
             this->randomPlay(symbolOfPlayer);
         } else {
-            this->board.setDataAt(typeid(double), actionID, symbolOfPlayer);
+            this->board.set(actionID, symbolOfPlayer);
         }
         this->currentTurn++;
         updateGame();
@@ -51,7 +51,7 @@ void TicTacToe::doAction(uint64_t actionID) {
             this->randomPlay(symbOfPlayer);
         } else {
             // update state
-            this->board.setDataAt(typeid(double), actionID, symbOfPlayer);
+            this->board.set(actionID, symbOfPlayer);
         }
 
         this->currentTurn++;
@@ -75,8 +75,8 @@ void TicTacToe::doAction(uint64_t actionID) {
 
 void TicTacToe::revertBoard() {
     for (int i=0;i<board.getLargestAddressSpace(); i++){
-        double cell = (double)*(this->board.getDataAt(typeid(double), i)).getSharedPointer<const double>();
-        board.setDataAt(typeid(double),i,cell == 0 ? 1 : cell==1?0:-1);
+        double cell = this->board.get(i);
+        board.set(i, cell == 0 ? 1 : cell==1?0:-1);
     }
 }
 
@@ -95,7 +95,7 @@ void TicTacToe::randomPlay(double symbolOfPlayer) {
 
     // i is the position of the n°decision empty slot
     // update state
-    this->board.setDataAt(typeid(double), i, symbolOfPlayer);
+    this->board.set(i, symbolOfPlayer);
 }
 
 void TicTacToe::reset(size_t seed, Learn::LearningMode mode, uint16_t iterationNumber, uint64_t generationNumber) {
@@ -104,7 +104,7 @@ void TicTacToe::reset(size_t seed, Learn::LearningMode mode, uint16_t iterationN
     this->rng.setSeed(hash_seed);
     // sets -1 for each cell to make them empty
     for (int i = 0; i < 9; i++) {
-        this->board.setDataAt(typeid(double), i, -1.0);
+        this->board.set(i, -1.0);
     }
     this->currentTurn = 0;
     this->winPlayer1 = false;
@@ -5,6 +5,8 @@
 
 #include <gegelati.h>
 
+#include "typedStateArray.h"
+
 #include "TicTacToe.h"
 
 /**
@@ -20,7 +22,7 @@ class TicTacToe : public Learn::AdversarialLearningEnvironment {
 protected:
   /// Current board containing -1 as empty, 0 as circles and 1 as crosses, size
   /// is 3*3 (row-order) (AI is circle)
-  Data::PrimitiveTypeArray<double> board;
+  TypedStateArray<double> board;
 
   /// The current turn being played
   int currentTurn;
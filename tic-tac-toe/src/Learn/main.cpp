@@ -6,8 +6,9 @@
 
 #include "TicTacToe.h"
 #include "resultTester.h"
+#include "asyncDotExporter.h"
 
-int main() {
+int main(int argc, char** argv) {
 
 
 	// Create the instruction set for programs
@@ -61,7 +62,11 @@ int main() {
 	auto logFile = *new Log::LABasicLogger(la, o);
 
 	// Create an exporter for all graphs
-	File::TPGGraphDotExporter dotExporter("out_000.dot", *la.getTPGGraph());
+	// (checkpoint period and rotation can be set with -dotPeriod and -dotKept)
+	uint64_t dotPeriod = 1;
+	size_t dotNbKept = 0;
+	AsyncDotExporter::parseCommandLine(argc, argv, dotPeriod, dotNbKept);
+	AsyncDotExporter dotExporter(*la.getTPGGraph(), dotPeriod, dotNbKept);
 
 	// File for printing best policy stat.
 	std::ofstream stats;
@@ -77,14 +82,16 @@ int main() {
 	for (int i = 0; i < params.nbGenerations; i++) {
 		char buff[12];
 		sprintf(buff, "out_%03d.dot", i);
-		dotExporter.setNewFilePath(buff);
-		dotExporter.print();
+		dotExporter.checkpoint(i, buff);
 		std::multimap<std::shared_ptr<Learn::EvaluationResult>, const TPG::TPGVertex*> result;
 		result = la.evaluateAllRoots(i, Learn::LearningMode::VALIDATION);
 
 		la.trainOneGeneration(i);
 	}
 
+	// Wait for the checkpoints, they share their programs with the graph.
+	dotExporter.flush();
+
 	// Keep best policy
 	la.keepBestPolicy();
 
@@ -92,8 +99,8 @@ int main() {
 	la.getTPGGraph()->clearProgramIntrons();
 
 	// Export the graph
-	dotExporter.setNewFilePath("out_best.dot");
-	dotExporter.print();
+	dotExporter.exportGraph("out_best.dot");
+	dotExporter.flush();
 
 	TPG::PolicyStats ps;
 	ps.setEnvironment(la.getTPGGraph()->getEnvironment());